@@ -1,6 +1,30 @@
+#include <iostream>
 #include <options-pricing-engine/Cli.hpp>
+#include <options-pricing-engine/Headless.hpp>
+#include <string_view>
 
-int main() {
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        std::string_view first = argv[1];
+        if (first == "--help" || first == "-h") {
+            std::cout << cli::usage;
+            return 0;
+        }
+        cli::HeadlessSettings settings;
+        try {
+            settings = cli::parseArguments(argc - 1, argv + 1);
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << e.what() << "\n\n" << cli::usage;
+            return 1;
+        }
+        try {
+            cli::runHeadless(settings);
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
     cli::CLI cli;
     cli.run();
     return 0;
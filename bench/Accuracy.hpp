@@ -0,0 +1,150 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <options-pricing-engine/Batch.hpp>
+#include <options-pricing-engine/MathKernels.hpp>
+#include <random>
+#include <vector>
+
+namespace bench {
+namespace accuracy {
+using Real = long double;
+
+inline Real normalCDF(Real x) { return 0.5L * std::erfc(-x / std::sqrt(2.0L)); }
+
+// AS241 refined by Newton steps in extended precision. The upper half is
+// taken from the lower by symmetry, where 1 - p is exact.
+inline Real inverseNormalCDF(double p) {
+    if (p > 0.5) {
+        return -inverseNormalCDF(1.0 - p);
+    }
+    Real x = math::inverseNormalCDF(p);
+    for (int i = 0; i < 3; ++i) {
+        Real pdf = std::exp(-0.5L * x * x) / std::sqrt(2.0L * M_PI);
+        x -= (normalCDF(x) - p) / pdf;
+    }
+    return x;
+}
+
+struct Case {
+    batch::MathFunction function;
+    math::ErrorBound bound;
+    bool relative;
+    std::vector<double> inputs;
+};
+
+// Uniform draws over [lo, hi] followed by denser draws over the inner range
+// where pricing inputs usually fall.
+inline std::vector<double> sample(std::mt19937_64 &generator, double lo,
+                                  double hi, double innerLo, double innerHi) {
+    constexpr std::size_t size = 1 << 18;
+    std::uniform_real_distribution<double> outer(lo, hi), inner(innerLo,
+                                                                innerHi);
+    std::vector<double> x(2 * size);
+    for (std::size_t i = 0; i < size; ++i) {
+        x[i] = outer(generator);
+        x[size + i] = inner(generator);
+    }
+    return x;
+}
+
+inline std::vector<Case> cases() {
+    using batch::MathFunction;
+    std::mt19937_64 generator(7);
+    std::vector<Case> result;
+    result.push_back({MathFunction::Exp, math::expError, true,
+                      sample(generator, -708.0, 709.0, -20.0, 20.0)});
+    std::vector<double> logInputs = sample(generator, -1020.0, 1020.0, -4.0,
+                                           4.0);
+    for (double &x : logInputs) {
+        x = std::exp2(x);
+    }
+    result.push_back({MathFunction::Log, math::logError, true, logInputs});
+    result.push_back({MathFunction::NormalCDF, math::normalCDFError, false,
+                      sample(generator, -40.0, 40.0, -8.0, 8.0)});
+    result.push_back({MathFunction::NormalPDF, math::normalPDFError, true,
+                      sample(generator, -37.0, 37.0, -8.0, 8.0)});
+    // Probabilities spread over every decade of both tails and the centre.
+    std::vector<double> p = sample(generator, -300.0, -1.0, 0.0, 1.0);
+    for (std::size_t i = 0; i < p.size(); ++i) {
+        if (i < p.size() / 2) {
+            p[i] = std::pow(10.0, p[i]);
+            p[i] = i % 2 ? p[i] : 1.0 - p[i];
+        }
+        p[i] = std::clamp(p[i], 1e-300, 1.0 - 1e-16);
+    }
+    result.push_back({MathFunction::InverseNormalCDF,
+                      math::inverseNormalCDFError, true, p});
+    return result;
+}
+
+inline Real reference(batch::MathFunction function, double x) {
+    switch (function) {
+    case batch::MathFunction::Exp:
+        return std::exp(static_cast<Real>(x));
+    case batch::MathFunction::Log:
+        return std::log(static_cast<Real>(x));
+    case batch::MathFunction::NormalCDF:
+        return normalCDF(x);
+    case batch::MathFunction::NormalPDF:
+        return std::exp(-0.5L * x * x) / std::sqrt(2.0L * M_PI);
+    default:
+        return inverseNormalCDF(x);
+    }
+}
+
+// Measures every kernel in both tiers at every supported SIMD level against
+// extended precision references and prints one line per combination.
+// Returns false if any error exceeds the documented bound.
+inline bool check() {
+    std::vector<batch::SimdLevel> levels{batch::SimdLevel::Scalar};
+    for (batch::SimdLevel level :
+         {batch::SimdLevel::AVX2, batch::SimdLevel::AVX512}) {
+        if (static_cast<int>(level) <=
+            static_cast<int>(batch::detectSimdLevel())) {
+            levels.push_back(level);
+        }
+    }
+    bool passed = true;
+    std::printf("%-20s %-6s %-7s %12s %12s\n", "kernel", "tier", "simd",
+                "max error", "bound");
+    for (const Case &c : cases()) {
+        std::vector<Real> expected(c.inputs.size());
+        for (std::size_t i = 0; i < c.inputs.size(); ++i) {
+            expected[i] = reference(c.function, c.inputs[i]);
+        }
+        std::vector<double> result(c.inputs.size());
+        for (math::Accuracy accuracy :
+             {math::Accuracy::Exact, math::Accuracy::Fast}) {
+            double bound = accuracy == math::Accuracy::Exact ? c.bound.exact
+                                                             : c.bound.fast;
+            for (batch::SimdLevel level : levels) {
+                batch::evaluate(c.function, c.inputs.data(), result.data(),
+                                c.inputs.size(), accuracy, level);
+                double worst = 0.0;
+                for (std::size_t i = 0; i < result.size(); ++i) {
+                    Real error = std::fabs(result[i] - expected[i]);
+                    if (c.relative && expected[i] != 0.0L) {
+                        error /= std::fabs(expected[i]);
+                    }
+                    if (std::isnan(error)) {
+                        worst = INFINITY;
+                    } else if (error > worst) {
+                        worst = static_cast<double>(error);
+                    }
+                }
+                bool ok = worst <= bound;
+                passed = passed && ok;
+                std::printf("%-20s %-6s %-7s %12.3e %12.3e%s\n",
+                            batch::toString(c.function),
+                            math::toString(accuracy), batch::toString(level),
+                            worst, bound, ok ? "" : "  FAILED");
+            }
+        }
+    }
+    return passed;
+}
+} // namespace accuracy
+} // namespace bench
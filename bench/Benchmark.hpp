@@ -0,0 +1,136 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+// Keeps the compiler from discarding a result that is otherwise unused.
+template <typename T> inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T *sink;
+    sink = &value;
+#endif
+}
+
+struct Result {
+    std::string name;
+    // Options priced by one call of the benchmarked operation.
+    std::size_t itemsPerOp{1};
+    std::size_t ops{0};
+    double nsPerOp{0.0};
+    double itemsPerSecond{0.0};
+    double p50{0.0};
+    double p99{0.0};
+};
+
+struct Settings {
+    // Substring a case name must contain to run; empty runs everything.
+    std::string filter;
+    double minSeconds{0.5};
+    std::size_t maxSamples{100000};
+};
+
+// Times an operation as a series of samples. Each sample runs the operation
+// enough times to last about sampleSeconds, so clock overhead stays small
+// for nanosecond operations, and the latency percentiles are taken over the
+// per-op time of each sample. Sampling stops after minSeconds and at least
+// minSamples samples, or at maxSamples.
+class Runner {
+  public:
+    explicit Runner(Settings settings) : m_settings(std::move(settings)) {}
+
+    template <typename Op>
+    void run(const std::string &name, std::size_t itemsPerOp, Op &&op) {
+        if (name.find(m_settings.filter) == std::string::npos) {
+            return;
+        }
+        using Clock = std::chrono::steady_clock;
+        auto seconds = [](Clock::duration d) {
+            return std::chrono::duration<double>(d).count();
+        };
+        // Warm up caches and lazily built state, then size the batches.
+        auto start = Clock::now();
+        op();
+        double single = std::max(seconds(Clock::now() - start), 1e-9);
+        std::size_t batch =
+            std::max<std::size_t>(1, static_cast<std::size_t>(
+                                         sampleSeconds / single));
+
+        std::vector<double> samples;
+        double total = 0.0;
+        std::size_t ops = 0;
+        while ((total < m_settings.minSeconds ||
+                samples.size() < minSamples) &&
+               samples.size() < m_settings.maxSamples) {
+            start = Clock::now();
+            for (std::size_t i = 0; i < batch; ++i) {
+                op();
+            }
+            double elapsed = seconds(Clock::now() - start);
+            samples.push_back(elapsed * 1e9 / batch);
+            total += elapsed;
+            ops += batch;
+        }
+        std::sort(samples.begin(), samples.end());
+        Result result;
+        result.name = name;
+        result.itemsPerOp = itemsPerOp;
+        result.ops = ops;
+        result.nsPerOp = total * 1e9 / ops;
+        result.itemsPerSecond = itemsPerOp * ops / total;
+        result.p50 = percentile(samples, 0.50);
+        result.p99 = percentile(samples, 0.99);
+        std::printf("%-40s %14.1f %14.0f %14.1f %14.1f\n", name.c_str(),
+                    result.nsPerOp, result.itemsPerSecond, result.p50,
+                    result.p99);
+        std::fflush(stdout);
+        m_results.push_back(result);
+    }
+
+    void printHeader() const {
+        std::printf("%-40s %14s %14s %14s %14s\n", "benchmark", "ns/op",
+                    "options/s", "p50 ns", "p99 ns");
+    }
+
+    // Writes every result as one JSON document for comparing runs.
+    void writeJson(const std::string &path, const std::string &simd,
+                   unsigned threads) const {
+        std::ofstream out(path);
+        out << "{\n  \"simd\": \"" << simd << "\",\n  \"threads\": "
+            << threads << ",\n  \"benchmarks\": [";
+        for (std::size_t i = 0; i < m_results.size(); ++i) {
+            const Result &r = m_results[i];
+            out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name
+                << "\", \"items_per_op\": " << r.itemsPerOp
+                << ", \"ops\": " << r.ops << ", \"ns_per_op\": " << r.nsPerOp
+                << ", \"options_per_sec\": " << r.itemsPerSecond
+                << ", \"p50_ns\": " << r.p50 << ", \"p99_ns\": " << r.p99
+                << "}";
+        }
+        out << "\n  ]\n}\n";
+        if (!out) {
+            throw std::runtime_error("Failed to write " + path + ".");
+        }
+    }
+
+  private:
+    static constexpr double sampleSeconds = 1e-4;
+    static constexpr std::size_t minSamples = 10;
+
+    static double percentile(const std::vector<double> &sorted, double q) {
+        std::size_t index = static_cast<std::size_t>(q * (sorted.size() - 1));
+        return sorted[index];
+    }
+
+    Settings m_settings;
+    std::vector<Result> m_results;
+};
+} // namespace bench
@@ -0,0 +1,101 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <options-pricing-engine/Model.hpp>
+#include <options-pricing-engine/Option.hpp>
+#include <vector>
+
+namespace bench {
+namespace convergence {
+// Error target the summary reports the cheapest configuration for.
+constexpr double target = 1e-4;
+
+struct Case {
+    const char *name;
+    options::ContractSpec spec;
+    double reference;
+};
+
+// Mean seconds per price, repeated until about 20ms have passed.
+inline double time(const options::ContractSpec &spec, int steps,
+                   const model::LatticeSettings &settings,
+                   model::LatticeWorkspace &workspace, double &price) {
+    using Clock = std::chrono::steady_clock;
+    int repetitions = 0;
+    auto start = Clock::now();
+    double elapsed = 0.0;
+    do {
+        price = model::latticePrice(spec, steps, settings, workspace);
+        ++repetitions;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < 0.02);
+    return elapsed / repetitions;
+}
+
+// Prices an out of the money European call, checked against the closed
+// form, and an American put, checked against a 20000 step BBSR tree, with
+// every lattice scheme and extrapolation over doubling step counts, then
+// prints for each configuration the fastest run within the error target.
+inline void report() {
+    using model::Extrapolation;
+    using model::LatticeScheme;
+    options::ContractSpec european{100.0, 105.0, 0.05, 1.0, 0.25, 0.02};
+    options::ContractSpec american = european;
+    american.type = options::OptionType::Put;
+    american.style = options::ExerciseStyle::American;
+    model::LatticeWorkspace workspace;
+    std::vector<Case> cases{
+        {"european call", european, model::blackScholesPrice(european)},
+        {"american put", american,
+         model::latticePrice(american, 20000,
+                             {LatticeScheme::CoxRossRubinstein,
+                              Extrapolation::SmoothedRichardson},
+                             workspace)}};
+    const std::vector<model::LatticeSettings> configurations{
+        {LatticeScheme::CoxRossRubinstein, Extrapolation::None},
+        {LatticeScheme::CoxRossRubinstein, Extrapolation::SmoothedRichardson},
+        {LatticeScheme::LeisenReimer, Extrapolation::None},
+        {LatticeScheme::LeisenReimer, Extrapolation::Richardson},
+        {LatticeScheme::Trinomial, Extrapolation::None},
+        {LatticeScheme::Trinomial, Extrapolation::SmoothedRichardson}};
+    for (const Case &c : cases) {
+        std::printf("%s, reference %.8f\n", c.name, c.reference);
+        std::printf("%-14s %-11s %6s %12s %12s\n", "scheme", "extrapolate",
+                    "steps", "error", "us");
+        std::vector<double> best(configurations.size(), INFINITY);
+        std::vector<int> bestSteps(configurations.size(), 0);
+        for (std::size_t k = 0; k < configurations.size(); ++k) {
+            const model::LatticeSettings &settings = configurations[k];
+            for (int steps = 25; steps <= 6400; steps *= 2) {
+                double price = 0.0;
+                double seconds =
+                    time(c.spec, steps, settings, workspace, price);
+                double error = std::fabs(price - c.reference);
+                std::printf("%-14s %-11s %6d %12.3e %12.2f\n",
+                            model::toString(settings.scheme),
+                            model::toString(settings.extrapolation), steps,
+                            error, 1e6 * seconds);
+                if (error <= target && seconds < best[k]) {
+                    best[k] = seconds;
+                    bestSteps[k] = steps;
+                }
+            }
+        }
+        std::printf("fastest within %.0e:\n", target);
+        for (std::size_t k = 0; k < configurations.size(); ++k) {
+            std::printf("  %-14s %-11s ",
+                        model::toString(configurations[k].scheme),
+                        model::toString(configurations[k].extrapolation));
+            if (bestSteps[k] == 0) {
+                std::printf("%6s\n", "-");
+            } else {
+                std::printf("%6d %12.2f us\n", bestSteps[k], 1e6 * best[k]);
+            }
+        }
+        std::printf("\n");
+    }
+}
+} // namespace convergence
+} // namespace bench
@@ -0,0 +1,614 @@
+#include "Accuracy.hpp"
+#include "Benchmark.hpp"
+#include "Convergence.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <options-pricing-engine/Batch.hpp>
+#include <options-pricing-engine/MathKernels.hpp>
+#include <options-pricing-engine/Model.hpp>
+#include <options-pricing-engine/Option.hpp>
+#include <options-pricing-engine/Portfolio.hpp>
+#include <options-pricing-engine/PricingCache.hpp>
+#include <options-pricing-engine/PricingGraph.hpp>
+#include <options-pricing-engine/Scenario.hpp>
+#include <options-pricing-engine/ThreadPool.hpp>
+#include <options-pricing-engine/Types.hpp>
+#include <options-pricing-engine/VolatilitySurface.hpp>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+constexpr const char *usage =
+    R"(Usage: options_pricing_bench [--filter TEXT] [--json PATH] [--min-time SECONDS]
+       options_pricing_bench --check-accuracy
+       options_pricing_bench --convergence
+
+  --filter TEXT       Only run cases whose name contains TEXT.
+  --json PATH         Also write the results as JSON to PATH.
+  --min-time SECONDS  Minimum sampling time per case (default 0.5).
+  --check-accuracy    Measure the math kernels against their documented
+                      error bounds instead, failing if any is exceeded.
+  --convergence       Compare the error against time of every lattice
+                      scheme and extrapolation instead.
+)";
+
+std::shared_ptr<options::Option>
+makeOption(options::OptionType type = options::OptionType::Call,
+           options::ExerciseStyle style = options::ExerciseStyle::European) {
+    return std::make_shared<options::Option>(100.0, 105.0, 0.05, "12mo", 0.2,
+                                             type, style, 0.01);
+}
+
+// A book of varied contracts so that batch cases do not see one repeated
+// row.
+batch::OptionBook makeBook(std::size_t size) {
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> strike(70.0, 130.0),
+        maturity(0.05, 2.0), volatility(0.1, 0.6);
+    batch::OptionBook book(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        book.add(100.0, strike(generator), 0.05, maturity(generator),
+                 volatility(generator),
+                 i % 2 ? options::OptionType::Put : options::OptionType::Call);
+    }
+    return book;
+}
+
+void blackScholes(bench::Runner &runner) {
+    model::BlackScholesModel model(makeOption());
+    runner.run("blackscholes/price", 1,
+               [&] { bench::doNotOptimize(model.calculatePrice()); });
+    runner.run("blackscholes/greeks", 1, [&] {
+        bench::doNotOptimize(model.calculateDelta());
+        bench::doNotOptimize(model.calculateGamma());
+        bench::doNotOptimize(model.calculateTheta());
+        bench::doNotOptimize(model.calculateVega());
+        bench::doNotOptimize(model.calculateRho());
+    });
+    runner.run("blackscholes/valuation", 1,
+               [&] { bench::doNotOptimize(model.calculateValuation()); });
+    model.setAccuracy(math::Accuracy::Fast);
+    runner.run("blackscholes/valuation/fast", 1,
+               [&] { bench::doNotOptimize(model.calculateValuation()); });
+    model.setAccuracy(math::Accuracy::Exact);
+    const Price marketPrice = model.calculatePrice();
+    runner.run("blackscholes/implied_volatility", 1,
+               [&] { bench::doNotOptimize(model.calculateIV(marketPrice)); });
+}
+
+void binomial(bench::Runner &runner) {
+    model::LatticeWorkspace workspace;
+    for (auto style : {options::ExerciseStyle::European,
+                       options::ExerciseStyle::American}) {
+        const std::string prefix = style == options::ExerciseStyle::European
+                                       ? "binomial/european/"
+                                       : "binomial/american/";
+        for (int steps : {100, 1000, 10000}) {
+            model::BinomialModel model(
+                makeOption(options::OptionType::Put, style), steps);
+            runner.run(prefix + std::to_string(steps), 1, [&] {
+                bench::doNotOptimize(model.calculatePrice(workspace));
+            });
+        }
+    }
+}
+
+// A 200 strike American put chain on 1000 step trees, one strike at a time
+// and on the shared tree at every instruction set the machine supports.
+void binomialChain(bench::Runner &runner) {
+    options::ContractSpec spec = makeOption(options::OptionType::Put,
+                                            options::ExerciseStyle::American)
+                                     ->getSpec();
+    std::vector<Price> strikes, prices(200);
+    for (int i = 0; i < 200; ++i) {
+        strikes.push_back(50.0 + 0.5 * i);
+    }
+    constexpr int steps = 1000;
+    model::LatticeWorkspace workspace;
+    runner.run("binomial/strikes/american/200x1000", strikes.size(), [&] {
+        options::ContractSpec strike = spec;
+        for (Price K : strikes) {
+            strike.strikePrice = K;
+            bench::doNotOptimize(
+                model::binomialPrice(strike, steps, workspace));
+        }
+    });
+    const batch::SimdLevel widest = batch::detectSimdLevel();
+    for (auto level : {batch::SimdLevel::Scalar, batch::SimdLevel::AVX2,
+                       batch::SimdLevel::AVX512}) {
+        if (static_cast<int>(level) > static_cast<int>(widest)) {
+            break;
+        }
+        runner.run(std::string("binomial/chain/american/200x1000/") +
+                       batch::toString(level),
+                   strikes.size(), [&] {
+                       batch::priceBinomialChain(spec, strikes.data(),
+                                                 strikes.size(), steps,
+                                                 prices.data(), level);
+                       bench::doNotOptimize(prices.front());
+                   });
+    }
+}
+
+// American puts across strikes and maturities, priced by the analytic
+// approximations with and without the lattice fallback.
+void american(bench::Runner &runner) {
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> strike(70.0, 130.0),
+        maturity(0.05, 2.0), volatility(0.1, 0.6);
+    std::vector<options::ContractSpec> specs;
+    for (int i = 0; i < 256; ++i) {
+        specs.push_back({100.0, strike(generator), 0.05, maturity(generator),
+                         volatility(generator), 0.01,
+                         options::OptionType::Put,
+                         options::ExerciseStyle::American});
+    }
+    for (auto method : {model::AmericanApproximation::BaroneAdesiWhaley,
+                        model::AmericanApproximation::BjerksundStensland}) {
+        model::AmericanSettings settings;
+        settings.method = method;
+        settings.fallbackSteps = 0;
+        runner.run(std::string("american/") + model::toString(method),
+                   specs.size(), [&] {
+                       for (const options::ContractSpec &spec : specs) {
+                           bench::doNotOptimize(
+                               model::americanPrice(spec, settings));
+                       }
+                   });
+    }
+    bool ran = false;
+    runner.run("american/fallback/200", specs.size(), [&] {
+        for (const options::ContractSpec &spec : specs) {
+            bench::doNotOptimize(model::americanPrice(spec));
+        }
+        ran = true;
+    });
+    if (!ran) {
+        return;
+    }
+    std::size_t fallbacks = 0;
+    for (const options::ContractSpec &spec : specs) {
+        fallbacks += model::americanEstimate(spec).fallback;
+    }
+    std::printf("  %-38s %13.1f%%\n", "fallback_rate",
+                100.0 * fallbacks / specs.size());
+}
+
+// One solve per contract against a binomial valuation per spot for a
+// strip of 101 spots, and the largest price gap between the two.
+void finiteDifference(bench::Runner &runner) {
+    options::ContractSpec spec = makeOption(options::OptionType::Put,
+                                            options::ExerciseStyle::American)
+                                     ->getSpec();
+    options::ContractSpec european = spec;
+    european.style = options::ExerciseStyle::European;
+    runner.run("pde/european/200x100", 1, [&] {
+        bench::doNotOptimize(model::finiteDifferencePrice(european));
+    });
+    for (auto exercise : {model::FiniteDifferenceExercise::Penalty,
+                          model::FiniteDifferenceExercise::ProjectedSor}) {
+        model::FiniteDifferenceSettings settings;
+        settings.exercise = exercise;
+        runner.run(std::string("pde/american/") + model::toString(exercise) +
+                       "/200x100",
+                   1, [&] {
+                       bench::doNotOptimize(
+                           model::finiteDifferencePrice(spec, settings));
+                   });
+    }
+    std::vector<Price> spots;
+    for (int i = 0; i <= 100; ++i) {
+        spots.push_back(80.0 + 0.4 * i);
+    }
+    bool ran = false;
+    runner.run("pde/american/strip/101", spots.size(), [&] {
+        model::FiniteDifferenceGrid grid = model::finiteDifferenceGrid(spec);
+        for (Price spot : spots) {
+            bench::doNotOptimize(grid.valuationAt(spot));
+        }
+        ran = true;
+    });
+    model::LatticeWorkspace workspace;
+    runner.run("binomial/american/strip/101x200", spots.size(), [&] {
+        options::ContractSpec shifted = spec;
+        for (Price spot : spots) {
+            shifted.spotPrice = spot;
+            bench::doNotOptimize(
+                model::binomialValuation(shifted, 200, workspace));
+        }
+    });
+    if (!ran) {
+        return;
+    }
+    model::FiniteDifferenceGrid grid = model::finiteDifferenceGrid(spec);
+    double gap = 0.0;
+    options::ContractSpec shifted = spec;
+    for (Price spot : spots) {
+        shifted.spotPrice = spot;
+        gap = std::max(gap, std::abs(grid.valuationAt(spot).price -
+                                     model::binomialPrice(shifted, 2000,
+                                                          workspace)));
+    }
+    std::printf("  %-38s %14.2e\n", "max_gap_vs_binomial_2000", gap);
+}
+
+void monteCarlo(bench::Runner &runner) {
+    for (int paths : {1000, 10000, 100000, 1000000}) {
+        model::MonteCarloModel model(makeOption(), paths, 42);
+        runner.run("montecarlo/price/" + std::to_string(paths), 1,
+                   [&] { bench::doNotOptimize(model.calculatePrice()); });
+    }
+    model::MonteCarloModel model(makeOption(), 100000, 42);
+    runner.run("montecarlo/valuation/100000", 1,
+               [&] { bench::doNotOptimize(model.calculateValuation()); });
+    model::MonteCarloModel american(
+        makeOption(options::OptionType::Put, options::ExerciseStyle::American),
+        100000, 42);
+    runner.run("montecarlo/american/100000x50", 1,
+               [&] { bench::doNotOptimize(american.calculatePrice()); });
+}
+
+void batchBook(bench::Runner &runner) {
+    constexpr std::size_t size = 4096;
+    batch::OptionBook book = makeBook(size);
+    batch::OptionBookView view = book.view();
+    std::vector<Price> prices(size);
+    std::vector<Rate> volatilities(size);
+    std::vector<batch::VolatilityStatus> status(size);
+    const std::string level = batch::toString(batch::detectSimdLevel());
+    runner.run("batch/price/" + level, size, [&] {
+        batch::priceBlackScholes(view, prices.data());
+        bench::doNotOptimize(prices.front());
+    });
+    runner.run("batch/price/scalar", size, [&] {
+        batch::priceBlackScholes(view, prices.data(),
+                                 batch::SimdLevel::Scalar);
+        bench::doNotOptimize(prices.front());
+    });
+    runner.run("batch/price/fast/" + level, size, [&] {
+        batch::priceBlackScholes(view, prices.data(), math::Accuracy::Fast);
+        bench::doNotOptimize(prices.front());
+    });
+    std::vector<Price> marketPrices(size);
+    batch::priceBlackScholes(view, marketPrices.data());
+    runner.run("batch/implied_volatility/" + level, size, [&] {
+        batch::impliedVolatility(view, marketPrices.data(),
+                                 volatilities.data(), status.data());
+        bench::doNotOptimize(volatilities.front());
+    });
+}
+
+// Each math kernel over an array in both tiers, on one lane and with the
+// widest instruction set.
+void mathKernels(bench::Runner &runner) {
+    using batch::MathFunction;
+    constexpr std::size_t size = 4096;
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> probability(1e-6, 1.0 - 1e-6),
+        argument(-8.0, 8.0);
+    std::vector<double> x(size), result(size);
+    std::vector<batch::SimdLevel> levels{batch::SimdLevel::Scalar};
+    if (batch::detectSimdLevel() != batch::SimdLevel::Scalar) {
+        levels.push_back(batch::detectSimdLevel());
+    }
+    for (MathFunction function :
+         {MathFunction::Exp, MathFunction::Log, MathFunction::NormalCDF,
+          MathFunction::NormalPDF, MathFunction::InverseNormalCDF}) {
+        for (double &value : x) {
+            value = function == MathFunction::InverseNormalCDF
+                        ? probability(generator)
+                        : argument(generator);
+            if (function == MathFunction::Log) {
+                value = std::exp(value);
+            }
+        }
+        for (math::Accuracy accuracy :
+             {math::Accuracy::Exact, math::Accuracy::Fast}) {
+            for (batch::SimdLevel level : levels) {
+                std::string name = std::string("math/") +
+                                   batch::toString(function) + "/" +
+                                   math::toString(accuracy) + "/" +
+                                   batch::toString(level);
+                runner.run(name, size, [&] {
+                    batch::evaluate(function, x.data(), result.data(), size,
+                                    accuracy, level);
+                    bench::doNotOptimize(result.front());
+                });
+            }
+        }
+    }
+}
+
+// Mostly closed form prices with a few deep American trees and Monte Carlo
+// positions, the mix that static partitioning balances badly.
+void mixedPortfolio(bench::Runner &runner) {
+    using portfolio::PricingModel;
+    batch::OptionBook book = makeBook(20000);
+    batch::OptionBookView view = book.view();
+    std::vector<portfolio::Position> positions;
+    for (std::size_t i = 0; i < view.size; ++i) {
+        options::Option option(view.spot[i], view.strike[i],
+                               view.interestRate[i], view.maturity[i],
+                               view.volatility[i], view.type[i]);
+        positions.push_back({option, PricingModel::BlackScholes});
+        if (i % 100 == 0) {
+            positions.push_back({option, PricingModel::MonteCarlo, 20000});
+        }
+        if (i % 2000 == 0) {
+            options::Option american(view.spot[i], view.strike[i],
+                                     view.interestRate[i], view.maturity[i],
+                                     view.volatility[i],
+                                     options::OptionType::Put,
+                                     options::ExerciseStyle::American);
+            positions.push_back({american, PricingModel::Binomial, 5000});
+        }
+    }
+    portfolio::PortfolioSettings settings;
+    settings.seed = 42;
+    portfolio::PortfolioReport report;
+    runner.run("portfolio/mixed", positions.size(), [&] {
+        report = portfolio::pricePortfolio(positions, settings);
+        bench::doNotOptimize(report.prices.front());
+    });
+    if (report.threads == 0) {
+        return;
+    }
+    for (std::size_t m = 0; m < portfolio::pricingModelCount; ++m) {
+        std::printf("  %-38s %13.1f%%\n",
+                    (std::string("utilization/") +
+                     portfolio::toString(static_cast<PricingModel>(m)))
+                        .c_str(),
+                    100.0 * report.models[m].utilization);
+    }
+}
+// A 20 by 50 quote grid on a quadratic smile: a full rebuild, a refresh
+// after one quote moves, and lookups at off-grid points.
+void volatilitySurface(bench::Runner &runner) {
+    const surface::Market market{100.0, 0.05, 0.01};
+    std::vector<double> maturities;
+    for (int e = 1; e <= 20; ++e) {
+        maturities.push_back(0.1 * e);
+    }
+    std::vector<Price> strikes;
+    for (int s = 0; s < 50; ++s) {
+        strikes.push_back(60.0 + 1.6 * s);
+    }
+    surface::SurfaceBuilder builder(market, maturities, strikes);
+    std::vector<Price> quotes(maturities.size() * strikes.size());
+    for (std::size_t e = 0; e < maturities.size(); ++e) {
+        for (std::size_t s = 0; s < strikes.size(); ++s) {
+            double k = std::log(strikes[s] / market.spot);
+            options::ContractSpec spec{
+                market.spot,   strikes[s], market.interestRate,
+                maturities[e], 0.2 - 0.1 * k + 0.3 * k * k, market.yield};
+            quotes[e * strikes.size() + s] = model::blackScholesPrice(spec);
+        }
+    }
+    auto setAll = [&] {
+        for (std::size_t e = 0; e < maturities.size(); ++e) {
+            for (std::size_t s = 0; s < strikes.size(); ++s) {
+                builder.setQuote(e, s, quotes[e * strikes.size() + s]);
+            }
+        }
+    };
+    std::shared_ptr<const surface::VolatilitySurface> snapshot;
+    runner.run("surface/refresh/full", quotes.size(), [&] {
+        setAll();
+        snapshot = builder.refresh();
+        bench::doNotOptimize(snapshot.get());
+    });
+    std::size_t tick = 0;
+    runner.run("surface/refresh/incremental", 1, [&] {
+        std::size_t e = tick++ % maturities.size();
+        builder.setQuote(e, 25, quotes[e * strikes.size() + 25]);
+        snapshot = builder.refresh();
+        bench::doNotOptimize(snapshot.get());
+    });
+    setAll();
+    snapshot = builder.refresh();
+    constexpr std::size_t lookups = 4096;
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> maturity(0.05, 2.5),
+        strike(50.0, 150.0);
+    std::vector<double> t(lookups), K(lookups);
+    for (std::size_t i = 0; i < lookups; ++i) {
+        t[i] = maturity(generator);
+        K[i] = strike(generator);
+    }
+    runner.run("surface/lookup", lookups, [&] {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < lookups; ++i) {
+            sum += snapshot->volatility(t[i], K[i]);
+        }
+        bench::doNotOptimize(sum);
+    });
+}
+// 500 underlyings with 20 closed form contracts each: a tick on one spot
+// against a rate move that reprices the whole book.
+void pricingGraph(bench::Runner &runner) {
+    constexpr std::size_t underlyings = 500;
+    constexpr std::size_t perUnderlying = 20;
+    graph::PricingGraph pricing(42);
+    graph::NodeId rate = pricing.addRate(0.05);
+    graph::NodeId volatility = pricing.addVolatility(0.2);
+    std::vector<graph::NodeId> spots;
+    for (std::size_t u = 0; u < underlyings; ++u) {
+        Price spot = 50.0 + 0.1 * u;
+        spots.push_back(pricing.addSpot(spot));
+        for (std::size_t c = 0; c < perUnderlying; ++c) {
+            options::ContractSpec spec;
+            spec.strikePrice = spot * (0.8 + 0.02 * c);
+            spec.maturity = 0.25 + 0.05 * c;
+            spec.type = c % 2 ? options::OptionType::Put
+                              : options::OptionType::Call;
+            pricing.addContract(spec, spots.back(), rate, volatility);
+        }
+    }
+    pricing.update();
+    std::size_t tick = 0;
+    runner.run("graph/tick/one_underlying", perUnderlying, [&] {
+        std::size_t u = tick++ % underlyings;
+        pricing.setSpot(spots[u], 50.0 + 0.1 * u + (tick % 2 ? 0.01 : 0.0));
+        bench::doNotOptimize(pricing.update());
+    });
+    runner.run("graph/tick/rate", underlyings * perUnderlying, [&] {
+        pricing.setRate(rate, tick++ % 2 ? 0.05 : 0.051);
+        bench::doNotOptimize(pricing.update());
+    });
+}
+// A 21 by 11 by 5 spot, volatility and rate grid over closed form and
+// American lattice books, with the closed form book also revalued by
+// calling the scalar price once per grid point for comparison.
+void scenarioGrid(bench::Runner &runner) {
+    using portfolio::PricingModel;
+    scenario::ShockGrid grid{scenario::ShockGrid::range(-0.2, 0.2, 21),
+                             scenario::ShockGrid::range(-0.1, 0.1, 11),
+                             scenario::ShockGrid::range(-0.01, 0.01, 5)};
+    batch::OptionBook book = makeBook(200);
+    batch::OptionBookView view = book.view();
+    std::vector<portfolio::Position> closedForm, lattice;
+    for (std::size_t i = 0; i < view.size; ++i) {
+        options::Option option(view.spot[i], view.strike[i],
+                               view.interestRate[i], view.maturity[i],
+                               view.volatility[i], view.type[i]);
+        closedForm.push_back({option, PricingModel::BlackScholes});
+        if (i % 20 == 0) {
+            options::Option american(view.spot[i], view.strike[i],
+                                     view.interestRate[i], view.maturity[i],
+                                     view.volatility[i],
+                                     options::OptionType::Put,
+                                     options::ExerciseStyle::American);
+            lattice.push_back({american, PricingModel::Binomial, 200});
+        }
+    }
+    scenario::PnLCube cube;
+    runner.run("scenario/closed_form", closedForm.size() * grid.size(), [&] {
+        cube = scenario::revalue(closedForm, grid);
+        bench::doNotOptimize(cube.values.front());
+    });
+    std::vector<double> naive(closedForm.size() * grid.size());
+    runner.run("scenario/closed_form/naive", naive.size(), [&] {
+        std::size_t cell = 0;
+        for (const portfolio::Position &position : closedForm) {
+            options::ContractSpec spec = position.option.getSpec();
+            Price base = model::blackScholesPrice(spec);
+            for (double rate : grid.rate) {
+                for (double volatility : grid.volatility) {
+                    for (double spot : grid.spot) {
+                        options::ContractSpec shocked = spec;
+                        shocked.spotPrice *= 1.0 + spot;
+                        shocked.volatility += volatility;
+                        shocked.interestRate += rate;
+                        naive[cell++] =
+                            model::blackScholesPrice(shocked) - base;
+                    }
+                }
+            }
+        }
+        bench::doNotOptimize(naive.front());
+    });
+    runner.run("scenario/lattice/200", lattice.size() * grid.size(), [&] {
+        cube = scenario::revalue(lattice, grid);
+        bench::doNotOptimize(cube.values.front());
+    });
+}
+// A stream of American lattice requests over 64 contracts whose spots
+// jitter below the quantization step, priced through a shared cache.
+void pricingCache(bench::Runner &runner) {
+    cache::CacheSettings settings;
+    settings.quantization.price = 0.01;
+    auto results = std::make_shared<cache::PricingCache>(settings);
+    std::mt19937_64 generator(42);
+    std::uniform_int_distribution<int> contract(0, 63);
+    std::uniform_real_distribution<double> jitter(-0.004, 0.004);
+    constexpr std::size_t requests = 1024;
+    std::vector<std::shared_ptr<options::Option>> stream;
+    for (std::size_t i = 0; i < requests; ++i) {
+        stream.push_back(std::make_shared<options::Option>(
+            100.0 + jitter(generator), 80.0 + contract(generator), 0.05, 1.0,
+            0.2, options::OptionType::Put, options::ExerciseStyle::American,
+            0.0));
+    }
+    model::BinomialModel model(stream.front(), 1000);
+    model.setCache(results);
+    runner.run("cache/binomial/american/1000", requests, [&] {
+        for (const std::shared_ptr<options::Option> &option : stream) {
+            model.setOption(option);
+            bench::doNotOptimize(model.calculatePrice());
+        }
+    });
+    cache::CacheStats stats = results->getStats();
+    if (stats.hits + stats.misses == 0) {
+        return;
+    }
+    std::printf("  %-38s %13.1f%%\n", "hit_rate", 100.0 * stats.hitRate());
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::Settings settings;
+    std::string json;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view option = argv[i];
+            if (option == "--help" || option == "-h") {
+                std::cout << usage;
+                return 0;
+            }
+            if (option == "--check-accuracy") {
+                return bench::accuracy::check() ? 0 : 1;
+            }
+            if (option == "--convergence") {
+                bench::convergence::report();
+                return 0;
+            }
+            if (i + 1 == argc) {
+                throw std::invalid_argument("Missing value for " +
+                                            std::string(option) + ".");
+            }
+            std::string value = argv[++i];
+            if (option == "--filter") {
+                settings.filter = value;
+            } else if (option == "--json") {
+                json = value;
+            } else if (option == "--min-time") {
+                settings.minSeconds = std::stod(value);
+            } else {
+                throw std::invalid_argument("Unknown option " +
+                                            std::string(option) + ".");
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << "\n\n" << usage;
+        return 1;
+    }
+
+    bench::Runner runner(settings);
+    runner.printHeader();
+    blackScholes(runner);
+    binomial(runner);
+    binomialChain(runner);
+    american(runner);
+    finiteDifference(runner);
+    monteCarlo(runner);
+    batchBook(runner);
+    mathKernels(runner);
+    mixedPortfolio(runner);
+    pricingCache(runner);
+    volatilitySurface(runner);
+    pricingGraph(runner);
+    scenarioGrid(runner);
+    if (!json.empty()) {
+        runner.writeJson(
+            json, batch::toString(batch::detectSimdLevel()),
+            parallel::ThreadPool::shared().getWorkers() + 1);
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <options-pricing-engine/MathKernels.hpp>
+#include <options-pricing-engine/Option.hpp>
+#include <options-pricing-engine/Types.hpp>
+#include <vector>
+
+namespace batch {
+enum class SimdLevel { Scalar, AVX2, AVX512 };
+
+// Cache line aligned storage so every column starts on a vector boundary.
+template <typename T, std::size_t Alignment = 64> struct AlignedAllocator {
+    using value_type = T;
+    template <typename U> struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+    T *allocate(std::size_t n) {
+        return static_cast<T *>(
+            ::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T *ptr, std::size_t) {
+        ::operator delete(ptr, std::align_val_t(Alignment));
+    }
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const {
+        return false;
+    }
+};
+template <typename T> using Column = std::vector<T, AlignedAllocator<T>>;
+
+// Non-owning structure-of-arrays view over an option book. The style column
+// may be null, in which case every row is treated as European.
+struct OptionBookView {
+    const Price *spot{nullptr};
+    const Price *strike{nullptr};
+    const Rate *interestRate{nullptr};
+    const Rate *volatility{nullptr};
+    const double *maturity{nullptr};
+    const Rate *yield{nullptr};
+    const options::OptionType *type{nullptr};
+    const options::ExerciseStyle *style{nullptr};
+    std::size_t size{0};
+};
+
+class OptionBook {
+  public:
+    OptionBook() = default;
+    explicit OptionBook(std::size_t capacity);
+    void add(const options::Option &option);
+    void add(Price spotPrice, Price strikePrice, Rate interestRate,
+             double maturity, Rate volatility, options::OptionType type,
+             options::ExerciseStyle style = options::ExerciseStyle::European,
+             Rate yield = 0.0);
+    void reserve(std::size_t capacity);
+    void clear();
+    std::size_t size() const { return m_spot.size(); }
+    OptionBookView view() const;
+
+  private:
+    Column<Price> m_spot;
+    Column<Price> m_strike;
+    Column<Rate> m_interestRate;
+    Column<Rate> m_volatility;
+    Column<double> m_maturity;
+    Column<Rate> m_yield;
+    Column<options::OptionType> m_type;
+    Column<options::ExerciseStyle> m_style;
+};
+
+SimdLevel detectSimdLevel();
+const char *toString(SimdLevel level);
+
+// Writes the Black-Scholes price of every row of the book to prices, which
+// must hold book.size elements. Uses the widest instruction set available
+// unless a level is requested explicitly, and the exact math kernels unless
+// the fast tier is requested.
+void priceBlackScholes(const OptionBookView &book, Price *prices);
+void priceBlackScholes(const OptionBookView &book, Price *prices,
+                       math::Accuracy accuracy);
+void priceBlackScholes(const OptionBookView &book, Price *prices,
+                       SimdLevel level,
+                       math::Accuracy accuracy = math::Accuracy::Exact);
+
+// Prices a chain of count strikes that share every other term of the spec,
+// whose own strike is ignored, on one Cox-Ross-Rubinstein tree of the given
+// steps: the prices binomialPrice gives one strike at a time, to rounding.
+// The strikes are the inner dimension of the backward induction, so each
+// tree level is swept once per tile of strikes rather than once per strike
+// and the strike loop runs in whole vectors. prices must hold count
+// elements.
+void priceBinomialChain(const options::ContractSpec &spec,
+                        const Price *strikes, std::size_t count, int steps,
+                        Price *prices);
+void priceBinomialChain(const options::ContractSpec &spec,
+                        const Price *strikes, std::size_t count, int steps,
+                        Price *prices, SimdLevel level);
+
+enum class MathFunction { Exp, Log, NormalCDF, NormalPDF, InverseNormalCDF };
+const char *toString(MathFunction function);
+
+// Applies a math kernel to n elements of x, writing result, which may alias
+// x. Inputs follow the domains documented in MathKernels.hpp.
+void evaluate(MathFunction function, const double *x, double *result,
+              std::size_t n, math::Accuracy accuracy = math::Accuracy::Exact);
+void evaluate(MathFunction function, const double *x, double *result,
+              std::size_t n, math::Accuracy accuracy, SimdLevel level);
+
+enum class VolatilityStatus : std::uint8_t {
+    Converged,
+    // The quote or its contract is not usable: non-positive inputs or an
+    // American exercise style.
+    InvalidInput,
+    // At or below the discounted intrinsic value, where no volatility fits.
+    BelowIntrinsic,
+    // At or above the no-arbitrage upper bound or the price at
+    // maxVolatility.
+    AboveMaximum,
+    // The iteration limit was hit; the volatility is the last iterate.
+    NotConverged
+};
+const char *toString(VolatilityStatus status);
+
+struct VolatilitySolverSettings {
+    Rate maxVolatility{10.0};
+    // Largest accepted change in volatility on the final iteration.
+    Rate tolerance{1e-10};
+    int maxIterations{64};
+};
+
+// Black-Scholes implied volatility of every row of the book from
+// marketPrices. The volatility column of the book is not read and may be
+// null. Quotes that cannot be inverted are reported through status rather
+// than exceptions; their volatility is NaN unless the status is
+// NotConverged. volatilities and status must hold book.size elements.
+void impliedVolatility(const OptionBookView &book, const Price *marketPrices,
+                       Rate *volatilities, VolatilityStatus *status,
+                       const VolatilitySolverSettings &settings = {});
+void impliedVolatility(const OptionBookView &book, const Price *marketPrices,
+                       Rate *volatilities, VolatilityStatus *status,
+                       const VolatilitySolverSettings &settings,
+                       SimdLevel level);
+} // namespace batch
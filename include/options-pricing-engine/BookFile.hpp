@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <options-pricing-engine/Batch.hpp>
+#include <string>
+
+namespace batch {
+// Binary columnar option book. A 64 byte aligned header is followed by one
+// column per field of OptionBookView, each starting on a 64 byte boundary so
+// the mapped columns can be handed to the vector kernels as they are.
+// Numbers are stored in native byte order and the header records it, so a
+// file is only read on machines of the same endianness.
+//
+//   offset 0   magic "OPEBOOK\0", version, column count, row count,
+//              byte order mark, then one BookFileColumn per field
+//   offset k   column data, padded to the next multiple of 64
+constexpr char bookFileMagic[8] = {'O', 'P', 'E', 'B', 'O', 'O', 'K', '\0'};
+constexpr std::uint32_t bookFileVersion = 1;
+
+enum class BookField : std::uint32_t {
+    Spot,
+    Strike,
+    InterestRate,
+    Volatility,
+    Maturity,
+    Yield,
+    Type,
+    Style
+};
+constexpr std::size_t bookFieldCount = 8;
+
+struct BookFileColumn {
+    BookField field;
+    std::uint32_t elementSize;
+    std::uint64_t offset;
+};
+
+struct alignas(64) BookFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t columnCount;
+    std::uint64_t rows;
+    std::uint32_t byteOrder;
+    std::uint32_t reserved;
+    BookFileColumn columns[bookFieldCount];
+};
+
+// Writes the book to path. A null style column is written as European.
+void writeBookFile(const std::string &path, const OptionBookView &book);
+
+// Read-only memory mapping of a book file. Opening checks the header and
+// the column bounds but never touches the column data, so it costs the same
+// for any number of rows; pages are read in by the kernels as they go. The
+// type and style bytes are not validated. The view stays valid for the
+// lifetime of the object.
+class MappedOptionBook {
+  public:
+    explicit MappedOptionBook(const std::string &path);
+    MappedOptionBook(const MappedOptionBook &) = delete;
+    MappedOptionBook &operator=(const MappedOptionBook &) = delete;
+    MappedOptionBook(MappedOptionBook &&other) noexcept;
+    MappedOptionBook &operator=(MappedOptionBook &&other) noexcept;
+    ~MappedOptionBook();
+    std::size_t size() const { return m_view.size; }
+    const OptionBookView &view() const { return m_view; }
+
+  private:
+    void unmap();
+    void *m_data{nullptr};
+    std::size_t m_length{0};
+    OptionBookView m_view;
+};
+} // namespace batch
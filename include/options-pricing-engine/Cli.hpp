@@ -74,6 +74,9 @@ class CLI {
     std::shared_ptr<model::BlackScholesModel> m_BSM;
     std::shared_ptr<model::BinomialModel> m_BM;
     std::shared_ptr<model::MonteCarloModel> m_MC;
+    // Exercise style the Monte Carlo settings were entered for; American
+    // contracts take exercise dates and no variance reduction.
+    options::ExerciseStyle m_MCStyle{options::ExerciseStyle::European};
     void clearScreen() const { std::cout << "\033[2J\033[1;1H"; }
     bool isOptionSet() const { return m_option != nullptr; }
     bool isBSMSet() const { return m_BSM != nullptr; }
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <options-pricing-engine/Model.hpp>
+#include <string>
+
+namespace cli {
+constexpr const char *usage = R"(Usage: options_pricing_engine [options]
+
+Without options the interactive menu is started. With options, every row of
+a portfolio file is priced and one line of results is written per row.
+
+  --input PATH               Portfolio file: .csv, .toml, a binary .book
+                             file, or - for CSV on standard input
+                             (required).
+  --output PATH              Results file, or - for standard output
+                             (default).
+  --write-book PATH          Convert the input to a binary .book file
+                             instead of pricing it.
+  --model NAME               blackscholes (default), binomial, montecarlo,
+                             american or pde.
+  --steps N                  Binomial steps, the fallback lattice steps of
+                             american and the time steps of pde
+                             (default 500).
+  --paths N                  Monte Carlo paths (default 100000).
+  --exercise-dates N         Exercise dates of American rows priced by
+                             montecarlo (default 50).
+  --seed N                   Monte Carlo seed shared by every row, 0 for a
+                             random one (default 0).
+  --variance-reduction NAME  none (default), antithetic, control or sobol.
+  --threads N                Worker threads, 0 for all cores (default 0).
+  --chunk-size N             Rows in flight per pipeline stage
+                             (default 4096).
+  --help                     Show this message.
+
+CSV input needs a header naming the columns spot, strike, interest,
+volatility and maturity ("12mo"), and optionally yield, type (call/put or
+0/1) and style (european/american or 0/1), in any order. TOML input holds
+an [[option]] array of tables with the keys of option.toml. Binary books
+are memory mapped, so they open instantly whatever their size.
+)";
+
+enum class HeadlessModel {
+    BlackScholes,
+    Binomial,
+    MonteCarlo,
+    American,
+    FiniteDifference
+};
+
+struct HeadlessSettings {
+    std::string input;
+    std::string output{"-"};
+    std::string writeBook;
+    HeadlessModel model{HeadlessModel::BlackScholes};
+    int steps{500};
+    int paths{100000};
+    int exerciseDates{50};
+    std::uint64_t seed{0};
+    model::VarianceReduction varianceReduction{model::VarianceReduction::None};
+    unsigned threads{0};
+    std::size_t chunkSize{4096};
+};
+
+// Parses the command line arguments after the program name. Throws
+// std::invalid_argument on unknown or malformed options.
+HeadlessSettings parseArguments(int argc, const char *const *argv);
+
+// Streams the portfolio through a three stage pipeline: a reader thread
+// parses chunks of rows, the calling thread prices each chunk on the shared
+// thread pool, and a writer thread formats and writes the results. At most
+// two chunks wait between stages, so memory does not grow with the file.
+// TOML files are parsed whole before streaming, so the bound holds for CSV
+// and binary books. With writeBook set the input is converted instead, which
+// holds the whole book in memory.
+// Rows that cannot be parsed or priced are reported in the error column and
+// do not stop the run; unreadable files and malformed headers throw.
+void runHeadless(const HeadlessSettings &settings);
+} // namespace cli
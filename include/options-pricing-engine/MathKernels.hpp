@@ -0,0 +1,390 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <options-pricing-engine/Types.hpp>
+#include <stdexcept>
+#include <type_traits>
+
+// Transcendental kernels of the pricing formulas in two accuracy tiers.
+//
+// Each kernel is written once in detail as a template over a vector type V
+// and instantiated for one double here and for AVX2 and AVX-512 registers
+// in the batch units. On one lane the C library's table driven exp and log
+// beat any polynomial, so the scalar functions below use them in both tiers
+// and branch where the vector forms blend. The bounds are the largest
+// errors over the stated domains, absolute for normalCDF and relative for
+// the others, and are checked against extended precision by
+// options_pricing_bench --check-accuracy.
+namespace math {
+enum class Accuracy { Exact, Fast };
+const char *toString(Accuracy accuracy);
+
+// Calls f with the accuracy as a compile time constant, like
+// options::dispatch.
+template <typename F> decltype(auto) dispatch(Accuracy accuracy, F &&f) {
+    switch (accuracy) {
+    case Accuracy::Exact:
+        return f(std::integral_constant<Accuracy, Accuracy::Exact>{});
+    case Accuracy::Fast:
+        return f(std::integral_constant<Accuracy, Accuracy::Fast>{});
+    default:
+        throw std::invalid_argument("Unknown accuracy.");
+    }
+}
+
+struct ErrorBound {
+    double exact;
+    double fast;
+};
+// exp on [-708, 709]; inputs outside are clamped.
+constexpr ErrorBound expError{3e-16, 7.5e-9};
+// log on positive normal inputs.
+constexpr ErrorBound logError{5e-16, 2.5e-9};
+constexpr ErrorBound normalCDFError{3e-16, 8e-8};
+// normalPDF for |x| <= 37; beyond, the vector forms return zero. The exact
+// bound is dominated by rounding x^2 / 2, which grows with |x|.
+constexpr ErrorBound normalPDFError{6e-14, 8e-9};
+// inverseNormalCDF for p in [1e-300, 1 - 1e-16].
+constexpr ErrorBound inverseNormalCDFError{1e-15, 1.3e-9};
+
+namespace detail {
+// V must provide broadcast/load/store, the arithmetic operators, fma, sqrt,
+// abs, min, max, select(mask, a, b), operator< / operator>, round, ldexp,
+// frexp (mantissa in [1, 2) and unbiased exponent) and loadSign, which maps
+// OptionType::Call to +1 and OptionType::Put to -1. Scalar is the one lane
+// implementation; fma is a plain multiply-add because std::fma is emulated
+// in software on targets without the instruction.
+struct Scalar {
+    static constexpr std::size_t width = 1;
+    double v;
+
+    static Scalar broadcast(double x) { return {x}; }
+    static Scalar load(const double *ptr) { return {*ptr}; }
+    static Scalar loadSign(const options::OptionType *ptr) {
+        return {*ptr == options::OptionType::Call ? 1.0 : -1.0};
+    }
+    void store(double *ptr) const { *ptr = v; }
+
+    friend Scalar operator+(Scalar a, Scalar b) { return {a.v + b.v}; }
+    friend Scalar operator-(Scalar a, Scalar b) { return {a.v - b.v}; }
+    friend Scalar operator*(Scalar a, Scalar b) { return {a.v * b.v}; }
+    friend Scalar operator/(Scalar a, Scalar b) { return {a.v / b.v}; }
+    friend bool operator<(Scalar a, Scalar b) { return a.v < b.v; }
+    friend bool operator>(Scalar a, Scalar b) { return a.v > b.v; }
+
+    static Scalar fma(Scalar a, Scalar b, Scalar c) {
+        return {a.v * b.v + c.v};
+    }
+    static Scalar sqrt(Scalar a) { return {std::sqrt(a.v)}; }
+    static Scalar abs(Scalar a) { return {std::fabs(a.v)}; }
+    static Scalar min(Scalar a, Scalar b) { return {std::min(a.v, b.v)}; }
+    static Scalar max(Scalar a, Scalar b) { return {std::max(a.v, b.v)}; }
+    static Scalar select(bool mask, Scalar a, Scalar b) {
+        return mask ? a : b;
+    }
+    // Rounds to nearest even by adding and removing 1.5 * 2^52, for
+    // |a| < 2^51, without a library call.
+    static Scalar round(Scalar a) {
+        const double shift = 6755399441055744.0;
+        return {(a.v + shift) - shift};
+    }
+    // Builds 2^n from the biased exponent; n is integral and within the
+    // normal range after exp clamps its argument.
+    static Scalar ldexp(Scalar a, Scalar n) {
+        std::uint64_t bits = static_cast<std::uint64_t>(
+                                 static_cast<std::int64_t>(n.v) + 1023)
+                             << 52;
+        double scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+        return {a.v * scale};
+    }
+    // Splits normal inputs with bit operations and leaves zeros, subnormals
+    // and non-finite values to the library.
+    static Scalar frexp(Scalar a, Scalar &exponent) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &a.v, sizeof(bits));
+        std::uint64_t biased = (bits >> 52) & 0x7FF;
+        if (biased == 0 || biased == 0x7FF) {
+            int e;
+            double m = std::frexp(a.v, &e);
+            exponent = {static_cast<double>(e - 1)};
+            return {2.0 * m};
+        }
+        exponent = {static_cast<double>(biased) - 1023.0};
+        bits = (bits & 0x800FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+        double m;
+        std::memcpy(&m, &bits, sizeof(m));
+        return {m};
+    }
+};
+
+// Evaluates c[0] + c[1] x + ... + c[N-1] x^(N-1) by Horner's rule.
+template <typename V, std::size_t N>
+inline V polynomial(const double (&c)[N], V x) {
+    V result = V::broadcast(c[N - 1]);
+    for (std::size_t i = N - 1; i-- > 0;) {
+        result = V::fma(result, x, V::broadcast(c[i]));
+    }
+    return result;
+}
+
+constexpr double invSqrt2Pi = 0.3989422804014327;
+
+// Taylor coefficients 1 / k!.
+constexpr double expExactSeries[] = {1.0,
+                                     1.0,
+                                     0.5,
+                                     1.0 / 6.0,
+                                     1.0 / 24.0,
+                                     1.0 / 120.0,
+                                     1.0 / 720.0,
+                                     1.0 / 5040.0,
+                                     1.0 / 40320.0,
+                                     1.0 / 362880.0,
+                                     1.0 / 3628800.0,
+                                     1.0 / 39916800.0,
+                                     1.0 / 479001600.0,
+                                     1.0 / 6227020800.0};
+constexpr double expFastSeries[] = {1.0,         1.0,         0.5,
+                                    1.0 / 6.0,   1.0 / 24.0,  1.0 / 120.0,
+                                    1.0 / 720.0, 1.0 / 5040.0};
+// Coefficients 1 / (2k + 1) of atanh(f) / f in powers of f^2.
+constexpr double logExactSeries[] = {
+    1.0,        1.0 / 3.0,  1.0 / 5.0,  1.0 / 7.0,  1.0 / 9.0, 1.0 / 11.0,
+    1.0 / 13.0, 1.0 / 15.0, 1.0 / 17.0, 1.0 / 19.0, 1.0 / 21.0};
+constexpr double logFastSeries[] = {1.0, 1.0 / 3.0, 1.0 / 5.0, 1.0 / 7.0,
+                                    1.0 / 9.0};
+
+// Wichura's AS241 (PPND16).
+constexpr double as241A[] = {
+    3.3871328727963666080e+0, 1.3314166789178437745e+2,
+    1.9715909503065514427e+3, 1.3731693765509461125e+4,
+    4.5921953931549871457e+4, 6.7265770927008700853e+4,
+    3.3430575583588128105e+4, 2.5090809287301226727e+3};
+constexpr double as241B[] = {
+    1.0,                      4.2313330701600911252e+1,
+    6.8718700749205790830e+2, 5.3941960214247511077e+3,
+    2.1213794301586595867e+4, 3.9307895800092710610e+4,
+    2.8729085735721942674e+4, 5.2264952788528545610e+3};
+constexpr double as241C[] = {
+    1.42343711074968357734e+0, 4.63033784615654529590e+0,
+    5.76949722146069140550e+0, 3.64784832476320460504e+0,
+    1.27045825245236838258e+0, 2.41780725177450611770e-1,
+    2.27238449892691845833e-2, 7.74545014278341407640e-4};
+constexpr double as241D[] = {
+    1.0,                       2.05319162663775882187e+0,
+    1.67638483018380384940e+0, 6.89767334985100004550e-1,
+    1.48103976427480074590e-1, 1.51986665636164571966e-2,
+    5.47593808499534494600e-4, 1.05075007164441684324e-9};
+constexpr double as241E[] = {
+    6.65790464350110377720e+0, 5.46378491116411436990e+0,
+    1.78482653991729133580e+0, 2.96560571828504891230e-1,
+    2.65321895265761230930e-2, 1.24266094738807843860e-3,
+    2.71155556874348757815e-5, 2.01033439929228813265e-7};
+constexpr double as241F[] = {
+    1.0,                       5.99832206555887937690e-1,
+    1.36929880922735805310e-1, 1.48753612908506148525e-2,
+    7.86869131145613259100e-4, 1.84631831751005468180e-5,
+    1.42151175831644588870e-7, 2.04426310338993978564e-15};
+
+// Acklam's rational approximation, central region and lower tail.
+constexpr double acklamA[] = {2.506628277459239e+00, -3.066479806614716e+01,
+                              1.383577518672690e+02, -2.759285104469687e+02,
+                              2.209460984245205e+02, -3.969683028665376e+01};
+constexpr double acklamB[] = {1.0,
+                              -1.328068155288572e+01,
+                              6.680131188771972e+01,
+                              -1.556989798598866e+02,
+                              1.615858368580409e+02,
+                              -5.447609879822406e+01};
+constexpr double acklamC[] = {2.938163982698783e+00, 4.374664141464968e+00,
+                              -2.549732539343734e+00, -2.400758277161838e+00,
+                              -3.223964580411365e-01, -7.784894002430293e-03};
+constexpr double acklamD[] = {1.0, 3.754408661907416e+00,
+                              2.445134137142996e+00, 3.224671290700398e-01,
+                              7.784695709041462e-03};
+
+// Reduces x = n ln(2) + r with |r| <= ln(2) / 2 and sums the Taylor series
+// of exp(r): to 13 terms in the exact tier and 7 in the fast one.
+template <typename V, Accuracy A = Accuracy::Exact> inline V exp(V x) {
+    if constexpr (A == Accuracy::Fast && std::is_same_v<V, Scalar>) {
+        return {std::exp(x.v)};
+    }
+    const V log2e = V::broadcast(1.4426950408889634);
+    const V minusLn2Hi = V::broadcast(-6.93145751953125e-1);
+    const V minusLn2Lo = V::broadcast(-1.42860682030941723212e-6);
+    x = V::min(V::max(x, V::broadcast(-708.0)), V::broadcast(709.0));
+    V n = V::round(x * log2e);
+    V r = V::fma(n, minusLn2Hi, x);
+    r = V::fma(n, minusLn2Lo, r);
+    if constexpr (A == Accuracy::Exact) {
+        return V::ldexp(polynomial(expExactSeries, r), n);
+    } else {
+        return V::ldexp(polynomial(expFastSeries, r), n);
+    }
+}
+
+// Natural logarithm for positive, normal inputs, as e ln(2) + 2 atanh(f)
+// with |f| <= 0.1716.
+template <typename V, Accuracy A = Accuracy::Exact> inline V log(V x) {
+    const V sqrt2 = V::broadcast(1.4142135623730951);
+    V e;
+    V m = V::frexp(x, e);
+    auto high = m > sqrt2;
+    m = V::select(high, m * V::broadcast(0.5), m);
+    e = V::select(high, e + V::broadcast(1.0), e);
+    V f = (m - V::broadcast(1.0)) / (m + V::broadcast(1.0));
+    V f2 = f * f;
+    V p;
+    if constexpr (A == Accuracy::Exact) {
+        p = polynomial(logExactSeries, f2);
+    } else {
+        p = polynomial(logFastSeries, f2);
+    }
+    V logM = V::broadcast(2.0) * f * p;
+    return V::fma(e, V::broadcast(0.6931471805599453), logM);
+}
+
+template <typename V, Accuracy A = Accuracy::Exact> inline V normalPDF(V x) {
+    V pdf = V::broadcast(invSqrt2Pi) *
+            exp<V, A>(V::broadcast(-0.5) * x * x);
+    return V::select(V::abs(x) > V::broadcast(37.0), V::broadcast(0.0), pdf);
+}
+
+// The exact tier is Hart's double precision rational approximation (West,
+// "Better approximations to cumulative normal functions", 2005) with both
+// branches evaluated and blended; the fast tier is Abramowitz and Stegun
+// 26.2.17.
+template <typename V, Accuracy A = Accuracy::Exact> inline V normalCDF(V x) {
+    V z = V::abs(x);
+    V e = exp<V, A>(V::broadcast(-0.5) * z * z);
+    V lower;
+    if constexpr (A == Accuracy::Exact) {
+        V n = V::broadcast(3.52624965998911e-02);
+        n = V::fma(n, z, V::broadcast(0.700383064443688));
+        n = V::fma(n, z, V::broadcast(6.37396220353165));
+        n = V::fma(n, z, V::broadcast(33.912866078383));
+        n = V::fma(n, z, V::broadcast(112.079291497871));
+        n = V::fma(n, z, V::broadcast(221.213596169931));
+        n = V::fma(n, z, V::broadcast(220.206867912376));
+        V d = V::broadcast(8.83883476483184e-02);
+        d = V::fma(d, z, V::broadcast(1.75566716318264));
+        d = V::fma(d, z, V::broadcast(16.064177579207));
+        d = V::fma(d, z, V::broadcast(86.7807322029461));
+        d = V::fma(d, z, V::broadcast(296.564248779674));
+        d = V::fma(d, z, V::broadcast(637.333633378831));
+        d = V::fma(d, z, V::broadcast(793.826512519948));
+        d = V::fma(d, z, V::broadcast(440.413735824752));
+        V central = e * n / d;
+
+        V c = z + V::broadcast(0.65);
+        c = z + V::broadcast(4.0) / c;
+        c = z + V::broadcast(3.0) / c;
+        c = z + V::broadcast(2.0) / c;
+        c = z + V::broadcast(1.0) / c;
+        V tail = e / (c * V::broadcast(2.506628274631));
+        lower = V::select(z < V::broadcast(7.07106781186547), central, tail);
+    } else {
+        V t = V::broadcast(1.0) /
+              V::fma(V::broadcast(0.2316419), z, V::broadcast(1.0));
+        V p = V::broadcast(1.330274429);
+        p = V::fma(p, t, V::broadcast(-1.821255978));
+        p = V::fma(p, t, V::broadcast(1.781477937));
+        p = V::fma(p, t, V::broadcast(-0.356563782));
+        p = V::fma(p, t, V::broadcast(0.319381530));
+        lower = V::broadcast(invSqrt2Pi) * e * t * p;
+    }
+    lower = V::select(z > V::broadcast(37.0), V::broadcast(0.0), lower);
+    return V::select(x > V::broadcast(0.0), V::broadcast(1.0) - lower,
+                     lower);
+}
+
+// Both tiers evaluate the central and tail branches and blend them; the
+// exact tier is AS241 and the fast tier Acklam's approximation.
+template <typename V, Accuracy A = Accuracy::Exact>
+inline V inverseNormalCDF(V p) {
+    const V zero = V::broadcast(0.0);
+    const V half = V::broadcast(0.5);
+    V q = p - half;
+    V tailP = V::min(p, V::broadcast(1.0) - p);
+    V central;
+    V tail;
+    if constexpr (A == Accuracy::Exact) {
+        V r = V::broadcast(0.180625) - q * q;
+        central = q * polynomial(as241A, r) / polynomial(as241B, r);
+        V s = V::sqrt(zero - log<V, A>(tailP));
+        V near = s - V::broadcast(1.6);
+        V far = s - V::broadcast(5.0);
+        tail = V::select(s > V::broadcast(5.0),
+                         polynomial(as241E, far) / polynomial(as241F, far),
+                         polynomial(as241C, near) / polynomial(as241D, near));
+        tail = V::select(q < zero, zero - tail, tail);
+        return V::select(V::abs(q) > V::broadcast(0.425), tail, central);
+    } else {
+        V r = q * q;
+        central = q * polynomial(acklamA, r) / polynomial(acklamB, r);
+        V s = V::sqrt(V::broadcast(-2.0) * log<V, A>(tailP));
+        tail = polynomial(acklamC, s) / polynomial(acklamD, s);
+        tail = V::select(q > zero, zero - tail, tail);
+        return V::select(V::abs(q) > V::broadcast(0.47575), tail, central);
+    }
+}
+} // namespace detail
+
+template <Accuracy A = Accuracy::Exact> inline double exp(double x) {
+    return std::exp(x);
+}
+
+template <Accuracy A = Accuracy::Exact> inline double log(double x) {
+    return std::log(x);
+}
+
+template <Accuracy A = Accuracy::Exact> inline double normalCDF(double x) {
+    if constexpr (A == Accuracy::Exact) {
+        return 0.5 * std::erfc(-x / std::sqrt(2.0));
+    } else {
+        return detail::normalCDF<detail::Scalar, A>({x}).v;
+    }
+}
+
+template <Accuracy A = Accuracy::Exact> inline double normalPDF(double x) {
+    return detail::invSqrt2Pi * std::exp(-0.5 * x * x);
+}
+
+// Inverse of the standard normal CDF for p in (0, 1).
+template <Accuracy A = Accuracy::Exact>
+inline double inverseNormalCDF(double p) {
+    using detail::polynomial;
+    using detail::Scalar;
+    double q = p - 0.5;
+    if constexpr (A == Accuracy::Exact) {
+        if (std::fabs(q) <= 0.425) {
+            Scalar r{0.180625 - q * q};
+            return q * polynomial(detail::as241A, r).v /
+                   polynomial(detail::as241B, r).v;
+        }
+        double s = std::sqrt(-std::log(q < 0.0 ? p : 1.0 - p));
+        Scalar near{s - 1.6};
+        Scalar far{s - 5.0};
+        double value =
+            s <= 5.0 ? polynomial(detail::as241C, near).v /
+                           polynomial(detail::as241D, near).v
+                     : polynomial(detail::as241E, far).v /
+                           polynomial(detail::as241F, far).v;
+        return q < 0.0 ? -value : value;
+    } else {
+        if (std::fabs(q) <= 0.47575) {
+            Scalar r{q * q};
+            return q * polynomial(detail::acklamA, r).v /
+                   polynomial(detail::acklamB, r).v;
+        }
+        Scalar s{std::sqrt(-2.0 * std::log(q < 0.0 ? p : 1.0 - p))};
+        double value =
+            polynomial(detail::acklamC, s).v / polynomial(detail::acklamD, s).v;
+        return q < 0.0 ? value : -value;
+    }
+}
+} // namespace math
@@ -1,19 +1,348 @@
 #pragma once
 #include <cmath>
+#include <cstddef>
 #include <memory>
+#include <cstdint>
+#include <optional>
+#include <options-pricing-engine/MathKernels.hpp>
 #include <options-pricing-engine/Option.hpp>
+#include <options-pricing-engine/Payoff.hpp>
+#include <options-pricing-engine/Random.hpp>
 #include <options-pricing-engine/Types.hpp>
 #include <options-pricing-engine/Utils.hpp>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
+namespace cache {
+class PricingCache;
+} // namespace cache
+
 namespace model {
+// Price together with first and second order sensitivities. Theta and charm
+// are the decay per year of the price and of delta respectively.
+struct Valuation {
+    Price price{0.0};
+    Greek delta{0.0};
+    Greek gamma{0.0};
+    Greek theta{0.0};
+    Greek vega{0.0};
+    Greek rho{0.0};
+    Greek vanna{0.0};
+    Greek volga{0.0};
+    Greek charm{0.0};
+};
+
+// Monte Carlo price with its standard error and a 95% confidence interval.
+// The variance reduction factor is the plain Monte Carlo variance for the
+// same number of payoff evaluations divided by the variance achieved.
+struct MonteCarloEstimate {
+    Price price{0.0};
+    double standardError{0.0};
+    Price lowerBound{0.0};
+    Price upperBound{0.0};
+    std::size_t paths{0};
+    double varianceReductionFactor{1.0};
+};
+
+// ControlVariate regresses on the terminal spot, whose discounted mean is
+// known in closed form. QuasiRandom uses randomised Sobol points.
+enum class VarianceReduction { None, Antithetic, ControlVariate, QuasiRandom };
+
+// Scratch buffers for the binomial rollback. Reusing one workspace across
+// calls on the same thread avoids reallocating the lattice every time.
+struct LatticeWorkspace {
+    std::vector<Price> values;
+    std::vector<Price> exercise;
+};
+
+struct MonteCarloSettings {
+    int paths{100000};
+    // Paths are drawn from Philox streams keyed by the seed, so a given
+    // seed reproduces the same estimate bit for bit on any thread count.
+    std::uint64_t seed{0};
+    // Upper bound on the threads used per estimate, 0 for the whole pool.
+    unsigned threads{0};
+    VarianceReduction varianceReduction{VarianceReduction::None};
+    // American contracts only: equally spaced exercise dates up to maturity,
+    // so a handful prices a Bermudan contract and many approach American
+    // exercise, and the degree of the polynomial in spot / strike that
+    // regresses continuation values on in the money paths.
+    int exerciseDates{50};
+    int basisDegree{3};
+    // Whether the contract may also be exercised today, which floors the
+    // price at the payoff; a Bermudan contract whose dates all lie ahead
+    // clears it, so one exercise date prices the European contract.
+    bool exerciseToday{true};
+};
+constexpr int maxBasisDegree = 4;
+
+// Pure pricing functions behind the model classes. They read nothing but
+// their arguments, so the same contract can be priced from any number of
+// threads without locks; bumped Greeks reprice local copies of the spec. A
+// payoff of std::nullopt means the vanilla payoff on the spec's type and
+// strike. The Black-Scholes functions throw for American contracts, which
+// monteCarloEstimate prices by least squares. The closed forms use the
+// exact tier of the math kernels unless the fast one is requested, which is
+// accurate to about 1e-7 in N(x) and pays off mostly in the vector kernels
+// of Batch.hpp.
+Price blackScholesPrice(options::ContractSpec spec,
+                        math::Accuracy accuracy = math::Accuracy::Exact);
+Greek blackScholesDelta(options::ContractSpec spec,
+                        math::Accuracy accuracy = math::Accuracy::Exact);
+Greek blackScholesGamma(options::ContractSpec spec,
+                        math::Accuracy accuracy = math::Accuracy::Exact);
+Greek blackScholesTheta(options::ContractSpec spec,
+                        math::Accuracy accuracy = math::Accuracy::Exact);
+Greek blackScholesVega(options::ContractSpec spec,
+                       math::Accuracy accuracy = math::Accuracy::Exact);
+Greek blackScholesRho(options::ContractSpec spec,
+                      math::Accuracy accuracy = math::Accuracy::Exact);
+Valuation
+blackScholesValuation(options::ContractSpec spec,
+                      math::Accuracy accuracy = math::Accuracy::Exact);
+// Spot independent part of the closed form price: sigma sqrt(T), the drift
+// term of d1 and both discount factors. Kept across spot moves, a reprice
+// costs one log and two normal CDFs.
+struct ClosedFormTerms {
+    double volSqrtT{0.0};
+    double drift{0.0};
+    double rateDiscount{1.0};
+    double yieldDiscount{1.0};
+};
+ClosedFormTerms
+blackScholesTerms(const options::ContractSpec &spec,
+                  math::Accuracy accuracy = math::Accuracy::Exact);
+// Price at the spec's spot from terms computed for the same contract at any
+// spot.
+Price blackScholesPrice(const options::ContractSpec &spec,
+                        const ClosedFormTerms &terms,
+                        math::Accuracy accuracy = math::Accuracy::Exact);
+// The volatility of the spec is ignored. Throws std::runtime_error when no
+// volatility reproduces the market price.
+Rate blackScholesImpliedVolatility(options::ContractSpec spec,
+                                   Price marketPrice);
+
+// Cox-Ross-Rubinstein tree parameters of a contract, which do not depend on
+// its spot.
+struct Lattice {
+    int steps;
+    double uptick;
+    double downtick;
+    double probability;
+    double discount;
+};
+Lattice binomialLattice(const options::ContractSpec &spec, int steps);
+
+Price binomialPrice(
+    options::ContractSpec spec, int steps, LatticeWorkspace &workspace,
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+// Price at the spec's spot on a lattice built for the same contract.
+Price binomialPrice(
+    const options::ContractSpec &spec, const Lattice &lattice,
+    LatticeWorkspace &workspace,
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+// Price, delta, gamma and theta at the root from a single rollback.
+Valuation binomialValuation(
+    options::ContractSpec spec, int steps, LatticeWorkspace &workspace,
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+
+// Leisen-Reimer centres a binomial tree on the strike through Peizer-Pratt
+// inversion and converges smoothly at second order; it needs an odd number
+// of steps, so even counts are rounded up. The trinomial tree is Boyle's,
+// with a stretch of sqrt(3), which oscillates less than CRR.
+enum class LatticeScheme { CoxRossRubinstein, LeisenReimer, Trinomial };
+// Richardson combines the prices at N and about N/2 steps to cancel the
+// leading error term, of order 1 / N^2 for European and 1 / N for American
+// contracts. It needs the smooth convergence of Leisen-Reimer trees: on CRR
+// and trinomial trees the error oscillates with the position of the strike
+// between nodes, which extrapolation amplifies, so it is rejected there.
+// SmoothedRichardson is Broadie and Detemple's BBSR: the last step is
+// replaced by Black-Scholes prices first, which removes the oscillation so
+// the extrapolation can be trusted on CRR and trinomial trees. Smoothing
+// needs the vanilla payoff and is rejected on Leisen-Reimer trees, whose
+// steps do not carry the Black-Scholes variance.
+enum class Extrapolation { None, Richardson, SmoothedRichardson };
+struct LatticeSettings {
+    LatticeScheme scheme{LatticeScheme::CoxRossRubinstein};
+    Extrapolation extrapolation{Extrapolation::None};
+    bool operator==(const LatticeSettings &other) const {
+        return scheme == other.scheme && extrapolation == other.extrapolation;
+    }
+};
+const char *toString(LatticeScheme scheme);
+const char *toString(Extrapolation extrapolation);
+
+// Lattice price with any scheme and extrapolation; the defaults give
+// binomialPrice.
+Price latticePrice(
+    options::ContractSpec spec, int steps, const LatticeSettings &settings,
+    LatticeWorkspace &workspace,
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+
+// Closed form approximations of American vanilla prices. Barone-Adesi-Whaley
+// is the quadratic approximation, which overprices long maturities;
+// Bjerksund-Stensland 2002 prices a two period flat exercise boundary and
+// so bounds the true price from below.
+enum class AmericanApproximation { BaroneAdesiWhaley, BjerksundStensland };
+const char *toString(AmericanApproximation method);
+struct AmericanSettings {
+    AmericanApproximation method{AmericanApproximation::BjerksundStensland};
+    // Error budget. A contract whose error estimate exceeds the larger of
+    // these, or whose critical spot does not converge, is priced on the
+    // lattice instead. The defaults keep most contracts of a typical book on
+    // the closed form; Bjerksund-Stensland itself is off by more than a
+    // cent on most at-the-money puts, so tighter budgets mostly fall back.
+    double absoluteTolerance{5e-2};
+    double relativeTolerance{2e-2};
+    // Steps of the CRR BBSR fallback lattice, 0 to never fall back.
+    int fallbackSteps{200};
+};
+// The error estimate is half the gap between the two approximations plus a
+// fifth of the early exercise premium, which is where both go wrong
+// together. It is fitted to lattice prices of random books and is an
+// estimate, not a bound.
+struct AmericanEstimate {
+    Price price{0.0};
+    double errorEstimate{0.0};
+    bool fallback{false};
+};
+// European contracts, calls without a yield and puts without a positive
+// rate are priced exactly in closed form. Greeks are central differences
+// on whichever route the price took; the cross Greeks are left at zero.
+AmericanEstimate americanEstimate(const options::ContractSpec &spec,
+                                  const AmericanSettings &settings = {});
+Price americanPrice(const options::ContractSpec &spec,
+                    const AmericanSettings &settings = {});
+Valuation americanValuation(const options::ContractSpec &spec,
+                            const AmericanSettings &settings = {});
+
+// Early exercise in the finite difference solver: Forsyth and Vetzal's
+// penalty iteration, a few tridiagonal solves per step, or projected SOR.
+enum class FiniteDifferenceExercise { Penalty, ProjectedSor };
+const char *toString(FiniteDifferenceExercise exercise);
+struct FiniteDifferenceSettings {
+    // Intervals of the spot grid and of the time grid.
+    int spotNodes{200};
+    int timeSteps{100};
+    // Crank-Nicolson steps replaced by two implicit Euler half steps each
+    // at expiry, which damps the oscillations the payoff kink excites.
+    int rannacherSteps{2};
+    // The spot grid runs from 0 to max(spot, strike) exp(width sigma
+    // sqrt(T)). A sinh map with scale concentration * strike * sigma
+    // sqrt(T) packs its nodes around the strike, which is always a node;
+    // smaller is denser.
+    double width{4.0};
+    double concentration{0.5};
+    FiniteDifferenceExercise exercise{FiniteDifferenceExercise::Penalty};
+    // Convergence of the exercise iteration, relative to the solution. The
+    // penalty factor is its inverse.
+    double tolerance{1e-8};
+    // Over-relaxation factor of projected SOR, in (0, 2).
+    double relaxation{1.2};
+};
+// Values and Greeks at every spot node at time zero, from one solve.
+// Delta and gamma are differences across the nodes and theta is taken
+// over the last time step, so repricing the contract at another spot is an
+// interpolation.
+struct FiniteDifferenceGrid {
+    std::vector<Price> spots;
+    std::vector<Price> values;
+    std::vector<Greek> deltas;
+    std::vector<Greek> gammas;
+    std::vector<Greek> thetas;
+    bool contains(Price spot) const {
+        return !spots.empty() && spot >= spots.front() &&
+               spot <= spots.back();
+    }
+    // Cubic Hermite interpolation of the price and delta, linear of gamma
+    // and theta. Throws std::out_of_range outside the grid.
+    Valuation valuationAt(Price spot) const;
+};
+// Crank-Nicolson with Rannacher start-up on the Black-Scholes PDE in the
+// spot, solved by the Thomas algorithm. The top boundary assumes zero
+// gamma. Vega, rho and the cross Greeks of the valuation are left at zero.
+FiniteDifferenceGrid finiteDifferenceGrid(
+    const options::ContractSpec &spec,
+    const FiniteDifferenceSettings &settings = {},
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+Price finiteDifferencePrice(
+    const options::ContractSpec &spec,
+    const FiniteDifferenceSettings &settings = {},
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+Valuation finiteDifferenceValuation(
+    const options::ContractSpec &spec,
+    const FiniteDifferenceSettings &settings = {},
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+
+MonteCarloEstimate monteCarloEstimate(
+    options::ContractSpec spec, const MonteCarloSettings &settings,
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+// Longstaff-Schwartz least squares Monte Carlo, behind monteCarloEstimate
+// for American contracts. Exercise only on the dates and a fitted rather
+// than optimal rule bias the price down, against the continuous American
+// value, by about two standard errors at the defaults; fitting on the
+// priced paths biases it up by less. The standard error leaves out the
+// regression noise. Only VarianceReduction::None is supported.
+MonteCarloEstimate longstaffSchwartzEstimate(
+    const options::ContractSpec &spec, const MonteCarloSettings &settings,
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+// Fits the exercise rule on spec, then prices each bumped copy of it on that
+// rule over the same paths instead of refitting, so bump-and-revalue Greeks
+// are not swamped by regression noise. The first price is spec's own, whose
+// whole estimate goes to estimate when it is set.
+std::vector<Price> longstaffSchwartzRevalue(
+    const options::ContractSpec &spec,
+    const std::vector<options::ContractSpec> &bumped,
+    const MonteCarloSettings &settings,
+    const std::optional<options::Payoff> &payoff = std::nullopt,
+    MonteCarloEstimate *estimate = nullptr);
+// Pathwise Greeks from one path set, or for American contracts the bumped
+// ones of longstaffSchwartzRevalue; see MonteCarloModel. When estimate is
+// set it receives the price estimate of the same paths, except that a
+// European contract with a variance reduction is priced by a run of its own.
+Valuation monteCarloValuation(
+    options::ContractSpec spec, const MonteCarloSettings &settings,
+    const std::optional<options::Payoff> &payoff = std::nullopt,
+    MonteCarloEstimate *estimate = nullptr);
+// Bump-and-reprice Greeks with common random numbers.
+Greek monteCarloDelta(
+    options::ContractSpec spec, const MonteCarloSettings &settings,
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+Greek monteCarloGamma(
+    options::ContractSpec spec, const MonteCarloSettings &settings,
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+Greek monteCarloTheta(
+    options::ContractSpec spec, const MonteCarloSettings &settings,
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+Greek monteCarloVega(
+    options::ContractSpec spec, const MonteCarloSettings &settings,
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+Greek monteCarloRho(
+    options::ContractSpec spec, const MonteCarloSettings &settings,
+    const std::optional<options::Payoff> &payoff = std::nullopt);
+
+// The model classes are thin wrappers that snapshot the shared option on
+// every call and hand it to the functions above.
 class Model {
   public:
     virtual ~Model() = default;
     virtual Price calculatePrice() const = 0;
     virtual void setOption(const std::shared_ptr<options::Option> &option) = 0;
+    // Prices and Greeks are looked up in the cache, which any number of
+    // models may share, before they are computed. Binomial node Greeks,
+    // implied volatilities, Monte Carlo and American estimates, finite
+    // difference grids and custom payoffs are never cached.
+    void setCache(std::shared_ptr<cache::PricingCache> cache) {
+        m_cache = std::move(cache);
+    }
+    const std::shared_ptr<cache::PricingCache> &getCache() const {
+        return m_cache;
+    }
+
+  protected:
+    std::shared_ptr<cache::PricingCache> m_cache;
 };
 
 class BlackScholesModel : public Model {
@@ -25,13 +354,17 @@ class BlackScholesModel : public Model {
     Greek calculateTheta() const;
     Greek calculateVega() const;
     Greek calculateRho() const;
+    Valuation calculateValuation() const;
     Rate calculateIV(const Price marketPrice) const;
     void setOption(const std::shared_ptr<options::Option> &option) override {
         m_option = option;
     }
+    void setAccuracy(math::Accuracy accuracy) { m_accuracy = accuracy; }
+    math::Accuracy getAccuracy() const { return m_accuracy; }
 
   private:
     std::shared_ptr<options::Option> m_option;
+    math::Accuracy m_accuracy{math::Accuracy::Exact};
 };
 
 class BinomialModel : public Model {
@@ -43,26 +376,67 @@ class BinomialModel : public Model {
     double getDowntick() const;
     double getProbability() const;
     Price calculatePrice() const override;
+    Price calculatePrice(LatticeWorkspace &workspace) const;
     Greek calculateDelta(int i, int j) const;
     Greek calculateGamma(int i, int j) const;
     Greek calculateTheta(int i, int j) const;
+    // Price, delta, gamma and theta at the root from a single rollback.
+    // Vega, rho and the second order cross Greeks are left at zero.
+    Valuation calculateValuation() const;
+    Valuation calculateValuation(LatticeWorkspace &workspace) const;
     void setOption(const std::shared_ptr<options::Option> &option) override;
+    // Replaces the vanilla payoff on the option's type and strike, for
+    // example with a digital or power payoff; std::nullopt restores it.
+    void setPayoff(std::optional<options::Payoff> payoff);
+    options::Payoff getPayoff() const;
+    // Tree and extrapolation used by calculatePrice. The uptick, downtick,
+    // probability and Greeks above always describe the CRR tree, so
+    // calculateValuation throws for other settings.
+    void setLatticeSettings(const LatticeSettings &settings) {
+        m_lattice = settings;
+    }
+    const LatticeSettings &getLatticeSettings() const { return m_lattice; }
 
   private:
     std::shared_ptr<options::Option> m_option;
+    std::optional<options::Payoff> m_payoff;
+    LatticeSettings m_lattice;
     int m_steps;
-    double m_uptick;
-    double m_downtick;
-    double m_probability;
-    std::vector<Price> getPayoffs() const;
-    std::vector<Price> getUpdatedPayoffs(const int i) const;
 };
 class MonteCarloModel : public Model {
   public:
     MonteCarloModel(const std::shared_ptr<options::Option> &option,
-                    const int &N);
-    int getN() const { return m_N; }
+                    const int &N, std::uint64_t seed = rng::randomSeed());
+    int getN() const { return m_settings.paths; }
+    std::uint64_t getSeed() const { return m_settings.seed; }
+    void setSeed(std::uint64_t seed) { m_settings.seed = seed; }
+    unsigned getThreads() const { return m_settings.threads; }
+    void setThreads(unsigned threads) { m_settings.threads = threads; }
+    VarianceReduction getVarianceReduction() const {
+        return m_settings.varianceReduction;
+    }
+    // Applies to calculateEstimate, calculatePrice and the bumped Greeks.
+    void setVarianceReduction(VarianceReduction mode) {
+        m_settings.varianceReduction = mode;
+    }
+    // Exercise schedule and regression of American contracts, which are
+    // priced by longstaffSchwartzEstimate.
+    int getExerciseDates() const { return m_settings.exerciseDates; }
+    void setExerciseDates(int dates) { m_settings.exerciseDates = dates; }
+    bool getExerciseToday() const { return m_settings.exerciseToday; }
+    void setExerciseToday(bool today) { m_settings.exerciseToday = today; }
+    int getBasisDegree() const { return m_settings.basisDegree; }
+    void setBasisDegree(int degree) { m_settings.basisDegree = degree; }
+    const MonteCarloSettings &getSettings() const { return m_settings; }
     Price calculatePrice() const override;
+    MonteCarloEstimate calculateEstimate() const;
+    // Price, delta, gamma, vega, rho and theta from a single path set using
+    // pathwise derivatives, with a likelihood ratio weight for gamma. Throws
+    // for payoffs without pathwise derivatives, such as digitals. American
+    // contracts are bumped and revalued on one fitted exercise rule and have
+    // no gamma or theta, which are NaN: paths that switch between exercise
+    // and continuation under a spot or maturity bump make them too noisy.
+    Valuation calculateValuation() const;
     Greek calculateDelta() const;
     Greek calculateGamma() const;
     Greek calculateTheta() const;
@@ -71,11 +445,69 @@ class MonteCarloModel : public Model {
     void setOption(const std::shared_ptr<options::Option> &option) override {
         m_option = option;
     }
+    // Replaces the vanilla payoff on the option's type and strike, for
+    // example with a digital or power payoff; std::nullopt restores it.
+    void setPayoff(std::optional<options::Payoff> payoff) {
+        m_payoff = std::move(payoff);
+    }
+    options::Payoff getPayoff() const;
+
+  private:
+    std::shared_ptr<options::Option> m_option;
+    std::optional<options::Payoff> m_payoff;
+    MonteCarloSettings m_settings;
+};
+
+// American and European vanillas through americanEstimate: closed form
+// speed where the error budget allows, the lattice where it does not.
+class AmericanApproximationModel : public Model {
+  public:
+    AmericanApproximationModel(const std::shared_ptr<options::Option> &option,
+                               const AmericanSettings &settings = {});
+    Price calculatePrice() const override;
+    AmericanEstimate calculateEstimate() const;
+    // Price, delta, gamma, theta, vega and rho; see americanValuation.
+    Valuation calculateValuation() const;
+    void setOption(const std::shared_ptr<options::Option> &option) override {
+        m_option = option;
+    }
+    void setSettings(const AmericanSettings &settings) {
+        m_settings = settings;
+    }
+    const AmericanSettings &getSettings() const { return m_settings; }
+
+  private:
+    std::shared_ptr<options::Option> m_option;
+    AmericanSettings m_settings;
+};
+
+// European and American contracts on the Crank-Nicolson grid; see
+// finiteDifferenceGrid.
+class FiniteDifferenceModel : public Model {
+  public:
+    FiniteDifferenceModel(const std::shared_ptr<options::Option> &option,
+                          const FiniteDifferenceSettings &settings = {});
+    Price calculatePrice() const override;
+    // Price, delta, gamma and theta at the option's spot.
+    Valuation calculateValuation() const;
+    // Values and Greeks at every node, to reprice other spots from.
+    FiniteDifferenceGrid calculateGrid() const;
+    void setOption(const std::shared_ptr<options::Option> &option) override {
+        m_option = option;
+    }
+    // Replaces the vanilla payoff on the option's type and strike, for
+    // example with a digital or power payoff; std::nullopt restores it.
+    void setPayoff(std::optional<options::Payoff> payoff) {
+        m_payoff = std::move(payoff);
+    }
+    void setSettings(const FiniteDifferenceSettings &settings) {
+        m_settings = settings;
+    }
+    const FiniteDifferenceSettings &getSettings() const { return m_settings; }
 
   private:
     std::shared_ptr<options::Option> m_option;
-    int m_N;
-    std::vector<Price> getStockPrices() const;
-    std::vector<Price> getPayoffs() const;
+    std::optional<options::Payoff> m_payoff;
+    FiniteDifferenceSettings m_settings;
 };
 } // namespace model
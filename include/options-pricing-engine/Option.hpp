@@ -1,36 +1,58 @@
-#pragma once
-#include <options-pricing-engine/Types.hpp>
-#include <stdexcept>
-#include <string_view>
-
-namespace options {
-
-class Option {
-  public:
-    Option(Price spotPrice, Price strikePrice, Rate interestRate,
-           std::string_view maturity, Rate volatility, OptionType type,
-           ExerciseStyle style = ExerciseStyle::European, Rate yield = 0.0);
-    Price getSpotPrice() const;
-    Price getStrikePrice() const;
-    Rate getInterestRate() const;
-    double getMaturity() const;
-    Rate getVolatility() const;
-    Rate getYield() const;
-    OptionType getType() const;
-    ExerciseStyle getStyle() const;
-    void setVolatility(Rate sigma);
-    void setSpotPrice(Price spotPrice);
-    void setInterestRate(Rate interestRate);
-    void setMaturity(double maturity);
-
-  private:
-    Price m_spotPrice;
-    Price m_strikePrice;
-    Rate m_interestRate;
-    double m_maturity;
-    Rate m_volatility;
-    Rate m_yield;
-    OptionType m_type;
-    ExerciseStyle m_style;
-};
-} // namespace options
+#pragma once
+#include <options-pricing-engine/Types.hpp>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace options {
+// Value snapshot of a contract, with maturity in years. It is trivially
+// copyable, so the pure pricing functions take it by value and any number
+// of threads can price the same contract without sharing state.
+struct ContractSpec {
+    Price spotPrice{0.0};
+    Price strikePrice{0.0};
+    Rate interestRate{0.0};
+    double maturity{0.0};
+    Rate volatility{0.0};
+    Rate yield{0.0};
+    OptionType type{OptionType::Call};
+    ExerciseStyle style{ExerciseStyle::European};
+};
+static_assert(std::is_trivially_copyable_v<ContractSpec>);
+
+class Option {
+  public:
+    Option(Price spotPrice, Price strikePrice, Rate interestRate,
+           std::string_view maturity, Rate volatility, OptionType type,
+           ExerciseStyle style = ExerciseStyle::European, Rate yield = 0.0);
+    // Maturity given directly in years.
+    Option(Price spotPrice, Price strikePrice, Rate interestRate,
+           double maturity, Rate volatility, OptionType type,
+           ExerciseStyle style = ExerciseStyle::European, Rate yield = 0.0);
+    // Validates the spec as the constructor above does.
+    explicit Option(const ContractSpec &spec);
+    ContractSpec getSpec() const;
+    Price getSpotPrice() const;
+    Price getStrikePrice() const;
+    Rate getInterestRate() const;
+    double getMaturity() const;
+    Rate getVolatility() const;
+    Rate getYield() const;
+    OptionType getType() const;
+    ExerciseStyle getStyle() const;
+    void setVolatility(Rate sigma);
+    void setSpotPrice(Price spotPrice);
+    void setInterestRate(Rate interestRate);
+    void setMaturity(double maturity);
+
+  private:
+    Price m_spotPrice;
+    Price m_strikePrice;
+    Rate m_interestRate;
+    double m_maturity;
+    Rate m_volatility;
+    Rate m_yield;
+    OptionType m_type;
+    ExerciseStyle m_style;
+};
+} // namespace options
@@ -0,0 +1,95 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <options-pricing-engine/Types.hpp>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+
+namespace options {
+// +1 for calls and -1 for puts.
+template <OptionType Type>
+constexpr double typeSign = Type == OptionType::Call ? 1.0 : -1.0;
+
+// Calls f with the option type or exercise style as a compile time
+// constant, so the switch happens once and the code inside f is
+// instantiated per case.
+template <typename F> decltype(auto) dispatch(OptionType type, F &&f) {
+    switch (type) {
+    case OptionType::Call:
+        return f(std::integral_constant<OptionType, OptionType::Call>{});
+    case OptionType::Put:
+        return f(std::integral_constant<OptionType, OptionType::Put>{});
+    default:
+        throw std::invalid_argument("Unknown option type.");
+    }
+}
+template <typename F> decltype(auto) dispatch(ExerciseStyle style, F &&f) {
+    switch (style) {
+    case ExerciseStyle::European:
+        return f(std::integral_constant<ExerciseStyle,
+                                        ExerciseStyle::European>{});
+    case ExerciseStyle::American:
+        return f(std::integral_constant<ExerciseStyle,
+                                        ExerciseStyle::American>{});
+    default:
+        throw std::invalid_argument("Unknown option exercise style.");
+    }
+}
+
+// Payoffs are function objects of the underlying price at exercise. A new
+// payoff needs operator(), derivative() (the slope almost everywhere) and
+// pathwise, which says whether derivative() gives unbiased pathwise Greeks,
+// and is then added to Payoff below.
+template <OptionType Type> struct VanillaPayoff {
+    static constexpr bool pathwise = true;
+    Price strike;
+    Price operator()(Price spot) const {
+        return std::max(typeSign<Type> * (spot - strike), 0.0);
+    }
+    double derivative(Price spot) const {
+        return typeSign<Type> * (spot - strike) > 0.0 ? typeSign<Type> : 0.0;
+    }
+};
+
+// Pays cash when the option finishes in the money.
+template <OptionType Type> struct DigitalPayoff {
+    static constexpr bool pathwise = false;
+    Price strike;
+    Price cash{1.0};
+    Price operator()(Price spot) const {
+        return typeSign<Type> * (spot - strike) > 0.0 ? cash : 0.0;
+    }
+    double derivative(Price) const { return 0.0; }
+};
+
+// Vanilla payoff on spot^exponent, struck in those units.
+template <OptionType Type> struct PowerPayoff {
+    static constexpr bool pathwise = true;
+    Price strike;
+    double exponent{2.0};
+    Price operator()(Price spot) const {
+        return std::max(typeSign<Type> * (std::pow(spot, exponent) - strike),
+                        0.0);
+    }
+    double derivative(Price spot) const {
+        Price powered = std::pow(spot, exponent);
+        return typeSign<Type> * (powered - strike) > 0.0
+                   ? typeSign<Type> * exponent * powered / spot
+                   : 0.0;
+    }
+};
+
+// Kernels visit the payoff once per call and run their loops on the
+// concrete type.
+using Payoff =
+    std::variant<VanillaPayoff<OptionType::Call>,
+                 VanillaPayoff<OptionType::Put>,
+                 DigitalPayoff<OptionType::Call>,
+                 DigitalPayoff<OptionType::Put>, PowerPayoff<OptionType::Call>,
+                 PowerPayoff<OptionType::Put>>;
+
+Payoff makeVanillaPayoff(OptionType type, Price strike);
+Payoff makeDigitalPayoff(OptionType type, Price strike, Price cash = 1.0);
+Payoff makePowerPayoff(OptionType type, Price strike, double exponent);
+} // namespace options
@@ -0,0 +1,106 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <options-pricing-engine/Model.hpp>
+#include <options-pricing-engine/Option.hpp>
+#include <options-pricing-engine/Types.hpp>
+#include <options-pricing-engine/VolatilitySurface.hpp>
+#include <string>
+#include <vector>
+
+namespace portfolio {
+// American prices through model::americanEstimate and FiniteDifference
+// through model::finiteDifferencePrice.
+enum class PricingModel {
+    BlackScholes,
+    Binomial,
+    MonteCarlo,
+    American,
+    FiniteDifference
+};
+constexpr std::size_t pricingModelCount = 5;
+const char *toString(PricingModel model);
+
+struct Position {
+    options::Option option;
+    PricingModel model{PricingModel::BlackScholes};
+    // Binomial steps, Monte Carlo paths, the fallback lattice steps of an
+    // American approximation or finite difference time steps, 0 for the
+    // portfolio default.
+    int resolution{0};
+};
+
+struct PortfolioSettings {
+    // Defaults for positions without a resolution of their own.
+    int binomialSteps{500};
+    int monteCarloPaths{100000};
+    // Monte Carlo seed shared by every position, 0 for a random one.
+    std::uint64_t seed{0};
+    model::VarianceReduction varianceReduction{model::VarianceReduction::None};
+    model::AmericanSettings american;
+    model::FiniteDifferenceSettings finiteDifference;
+    // Worker threads, 0 for the whole shared pool.
+    unsigned threads{0};
+    // Estimated cost each task should reach before it is cut, so cheap
+    // positions are priced in groups and expensive ones alone.
+    double grainNanoseconds{50000.0};
+    // When set, every position is priced with the surface's volatility at
+    // its maturity and strike instead of its own.
+    std::shared_ptr<const surface::VolatilitySurface> surface;
+};
+
+struct ModelUtilization {
+    std::size_t positions{0};
+    std::size_t tasks{0};
+    // Thread time spent pricing this model's positions.
+    double busySeconds{0.0};
+    // busySeconds as a share of wall time times threads.
+    double utilization{0.0};
+};
+
+struct PortfolioReport {
+    // One entry per position; failed positions have a NaN price and an
+    // error message.
+    std::vector<Price> prices;
+    std::vector<std::string> errors;
+    std::array<ModelUtilization, pricingModelCount> models;
+    double wallSeconds{0.0};
+    unsigned threads{0};
+};
+
+// Estimated nanoseconds to price a position, used to balance the schedule.
+double estimateCost(const Position &position,
+                    const PortfolioSettings &settings);
+
+// A position's model settings: its own resolution where it has one, the
+// portfolio defaults otherwise. resolution is the binomial steps or Monte
+// Carlo paths.
+int resolution(const Position &position, const PortfolioSettings &settings);
+model::AmericanSettings americanSettings(const Position &position,
+                                         const PortfolioSettings &settings);
+model::FiniteDifferenceSettings
+finiteDifferenceSettings(const Position &position,
+                         const PortfolioSettings &settings);
+// One thread on seed. American contracts get no variance reduction, which
+// Longstaff-Schwartz does not support.
+model::MonteCarloSettings monteCarloSettings(const Position &position,
+                                             const PortfolioSettings &settings,
+                                             std::uint64_t seed);
+
+// Prices spec, the position's contract or a shocked copy of it, with the
+// position's model and settings.
+Price pricePosition(const Position &position,
+                    const options::ContractSpec &spec,
+                    const PortfolioSettings &settings, std::uint64_t seed);
+
+// Prices every position with its model on the shared thread pool. Positions
+// are grouped into tasks of about grainNanoseconds of estimated work, which
+// are ordered by decreasing cost and balanced by work stealing, so a few
+// deep lattices start first instead of straggling behind many closed form
+// prices. Positions are priced through the pure functions of Model.hpp, so
+// they are only read. Monte Carlo positions run on one thread each.
+PortfolioReport pricePortfolio(const std::vector<Position> &positions,
+                               const PortfolioSettings &settings = {});
+} // namespace portfolio
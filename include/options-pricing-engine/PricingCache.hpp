@@ -0,0 +1,141 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <options-pricing-engine/Model.hpp>
+#include <options-pricing-engine/Option.hpp>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cache {
+enum class ModelKind : std::uint8_t {
+    BlackScholes,
+    Binomial,
+    MonteCarlo,
+    American,
+    FiniteDifference
+};
+enum class Quantity : std::uint8_t {
+    Price,
+    Delta,
+    Gamma,
+    Theta,
+    Vega,
+    Rho,
+    Valuation
+};
+
+// Steps the contract inputs are rounded to before they are compared.
+// Contracts whose inputs round to the same multiples share an entry, so the
+// first result computed for them is returned for all. A step of 0 keys on
+// the exact value.
+struct Quantization {
+    // Spot and strike.
+    double price{0.0};
+    // Interest rate, yield and volatility.
+    double rate{0.0};
+    double maturity{0.0};
+};
+
+struct CacheSettings {
+    // Entries kept before the least recently used are evicted. The capacity
+    // is split exactly over the shards, and each shard evicts once it holds
+    // its share, so a skewed key spread can evict before the cache is full.
+    std::size_t capacity{1 << 16};
+    Quantization quantization;
+};
+
+struct CacheStats {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t evictions{0};
+    std::size_t size{0};
+    double hitRate() const {
+        std::uint64_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+    }
+};
+
+// Model settings keyed on besides the resolution, seed and variant, such as
+// tolerances bit for bit or exercise date counts; unused slots are zero.
+using Parameters = std::array<std::uint64_t, 5>;
+
+// Quantized contract inputs together with the model, its parameters and the
+// quantity computed. The variant is the math accuracy of the closed form or
+// the variance reduction of Monte Carlo.
+struct Key {
+    std::array<std::int64_t, 6> inputs;
+    Parameters parameters;
+    std::uint64_t seed;
+    std::int32_t resolution;
+    ModelKind model;
+    Quantity quantity;
+    std::uint8_t variant;
+    options::OptionType type;
+    options::ExerciseStyle style;
+
+    bool operator==(const Key &other) const {
+        return inputs == other.inputs && parameters == other.parameters &&
+               seed == other.seed &&
+               resolution == other.resolution && model == other.model &&
+               quantity == other.quantity && variant == other.variant &&
+               type == other.type && style == other.style;
+    }
+};
+
+// Thread-safe result cache with least recently used eviction and bounded
+// memory. Entries are spread over independently locked shards, each with
+// its own recency list, so concurrent lookups rarely contend. A value is
+// computed outside the lock, so two threads missing on the same key at once
+// both compute it. Scalar quantities are stored in the price field of the
+// valuation.
+class PricingCache {
+  public:
+    explicit PricingCache(const CacheSettings &settings = {});
+    Key makeKey(const options::ContractSpec &spec, ModelKind model,
+                Quantity quantity, int resolution = 0,
+                std::uint64_t seed = 0, std::uint8_t variant = 0,
+                const Parameters &parameters = {}) const;
+    std::optional<model::Valuation> find(const Key &key);
+    void insert(const Key &key, const model::Valuation &value);
+    template <typename F>
+    model::Valuation getOrCompute(const Key &key, F &&compute) {
+        if (std::optional<model::Valuation> cached = find(key)) {
+            return *cached;
+        }
+        model::Valuation value = compute();
+        insert(key, value);
+        return value;
+    }
+    CacheStats getStats() const;
+    // Drops every entry and resets the statistics.
+    void clear();
+    const CacheSettings &getSettings() const { return m_settings; }
+
+  private:
+    struct KeyHash {
+        std::size_t operator()(const Key &key) const;
+    };
+    using Entry = std::pair<Key, model::Valuation>;
+    struct Shard {
+        mutable std::mutex mutex;
+        // Most recently used first.
+        std::list<Entry> entries;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+        std::uint64_t hits{0};
+        std::uint64_t misses{0};
+        std::uint64_t evictions{0};
+        // This shard's share of the capacity.
+        std::size_t capacity{0};
+    };
+    Shard &shard(const Key &key);
+
+    CacheSettings m_settings;
+    std::vector<Shard> m_shards;
+};
+} // namespace cache
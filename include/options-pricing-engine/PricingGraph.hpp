@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <options-pricing-engine/Model.hpp>
+#include <options-pricing-engine/Option.hpp>
+#include <options-pricing-engine/Portfolio.hpp>
+#include <options-pricing-engine/Types.hpp>
+#include <options-pricing-engine/VolatilitySurface.hpp>
+#include <vector>
+
+namespace graph {
+// Market inputs and contracts are referred to by the index they were added
+// at.
+using NodeId = std::size_t;
+using ContractId = std::size_t;
+
+struct UpdateStats {
+    std::size_t repriced{0};
+    // Contracts whose spot independent terms were rebuilt because their
+    // rate or volatility moved.
+    std::size_t rebuilt{0};
+};
+
+// Live pricing graph. Market inputs, a spot per underlying, rates and flat
+// volatilities or surfaces, are nodes, and every contract subscribes to one
+// node of each kind. Setting a node only marks its subscribers; update then
+// reprices just those contracts, in parallel. Each contract keeps its spot
+// independent terms, the discount factors and sigma sqrt(T) of the closed
+// form or the tree parameters of the lattice, so a spot tick skips them and
+// only a rate or volatility change rebuilds them. Finite difference
+// contracts keep their whole solved grid, so a spot tick inside it is an
+// interpolation. Monte Carlo contracts are fully repriced on any change.
+class PricingGraph {
+  public:
+    // Monte Carlo seed shared by every contract, 0 for a random one.
+    explicit PricingGraph(std::uint64_t seed = 0);
+
+    NodeId addSpot(Price spot);
+    NodeId addRate(Rate rate);
+    NodeId addVolatility(Rate volatility);
+    // Contracts on a surface read the volatility at their maturity and
+    // strike.
+    NodeId
+    addSurface(std::shared_ptr<const surface::VolatilitySurface> surface);
+    void setSpot(NodeId node, Price spot);
+    void setRate(NodeId node, Rate rate);
+    void setVolatility(NodeId node, Rate volatility);
+    void
+    setSurface(NodeId node,
+               std::shared_ptr<const surface::VolatilitySurface> surface);
+
+    // The spec supplies the strike, maturity, yield, type and style; its
+    // spot, rate and volatility are read from the nodes. The resolution is
+    // the binomial steps, Monte Carlo paths, American fallback steps or
+    // finite difference time steps, 0 for the portfolio defaults.
+    ContractId
+    addContract(const options::ContractSpec &spec, NodeId spot, NodeId rate,
+                NodeId volatility,
+                portfolio::PricingModel model =
+                    portfolio::PricingModel::BlackScholes,
+                int resolution = 0);
+
+    // Reprices the contracts whose inputs changed since the last update.
+    // Contracts that fail to price get a NaN price.
+    UpdateStats update();
+    // Price as of the last update.
+    Price getPrice(ContractId contract) const;
+    std::size_t getContracts() const { return m_contracts.size(); }
+    // Contracts waiting for the next update.
+    std::size_t getPending() const { return m_pending.size(); }
+
+  private:
+    enum class NodeKind { Spot, Rate, Volatility };
+    enum Dirty : std::uint8_t { PriceDirty = 1, TermsDirty = 2 };
+    struct Node {
+        NodeKind kind;
+        double value;
+        std::shared_ptr<const surface::VolatilitySurface> surface;
+        std::vector<ContractId> subscribers;
+    };
+    struct Contract {
+        options::ContractSpec spec;
+        NodeId spot;
+        NodeId rate;
+        NodeId volatility;
+        portfolio::PricingModel model;
+        int resolution;
+        model::ClosedFormTerms terms;
+        model::Lattice lattice;
+        model::FiniteDifferenceGrid grid;
+        Price price;
+        std::uint8_t dirty;
+    };
+    NodeId addNode(NodeKind kind);
+    Node &node(NodeId id, NodeKind kind);
+    void mark(const Node &node, std::uint8_t dirty);
+    void reprice(Contract &contract) const;
+
+    std::uint64_t m_seed;
+    std::vector<Node> m_nodes;
+    std::vector<Contract> m_contracts;
+    std::vector<ContractId> m_pending;
+};
+} // namespace graph
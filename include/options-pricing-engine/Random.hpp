@@ -0,0 +1,159 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <options-pricing-engine/Utils.hpp>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace rng {
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3", SC11). Output is a pure function of the key
+// and the counter, so any sub-stream can be produced on any thread in any
+// order without shared state.
+class Philox4x32 {
+  public:
+    using Counter = std::array<std::uint32_t, 4>;
+    explicit Philox4x32(std::uint64_t seed)
+        : m_key{static_cast<std::uint32_t>(seed),
+                static_cast<std::uint32_t>(seed >> 32)} {}
+
+    Counter operator()(Counter counter) const {
+        std::uint32_t k0 = m_key[0], k1 = m_key[1];
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+            std::uint64_t p0 = std::uint64_t{0xD2511F53u} * counter[0];
+            std::uint64_t p1 = std::uint64_t{0xCD9E8D57u} * counter[2];
+            counter = {static_cast<std::uint32_t>(p1 >> 32) ^ counter[1] ^ k0,
+                       static_cast<std::uint32_t>(p1),
+                       static_cast<std::uint32_t>(p0 >> 32) ^ counter[3] ^ k1,
+                       static_cast<std::uint32_t>(p0)};
+        }
+        return counter;
+    }
+    // Counter words 0-1 hold the draw index and words 2-3 the stream.
+    Counter operator()(std::uint64_t stream, std::uint64_t index) const {
+        return (*this)({static_cast<std::uint32_t>(index),
+                        static_cast<std::uint32_t>(index >> 32),
+                        static_cast<std::uint32_t>(stream),
+                        static_cast<std::uint32_t>(stream >> 32)});
+    }
+
+  private:
+    std::array<std::uint32_t, 2> m_key;
+};
+
+// Maps 64 random bits to a double strictly inside (0, 1).
+inline double toUniform(std::uint32_t high, std::uint32_t low) {
+    std::uint64_t bits = ((std::uint64_t{high} << 32) | low) >> 11;
+    return (static_cast<double>(bits) + 0.5) * 0x1.0p-53;
+}
+
+// Fills out with n uniforms from one stream. Each generator call yields
+// two doubles, so draw i always comes from counter i / 2.
+inline void fillUniforms(const Philox4x32 &generator, std::uint64_t stream,
+                         double *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; i += 2) {
+        auto bits = generator(stream, i / 2);
+        out[i] = toUniform(bits[0], bits[1]);
+        if (i + 1 < n) {
+            out[i + 1] = toUniform(bits[2], bits[3]);
+        }
+    }
+}
+
+// Standard normals by inverse CDF. Uniforms are produced for the whole
+// block first so the transform runs as a separate, branch-light loop.
+inline void fillNormals(const Philox4x32 &generator, std::uint64_t stream,
+                        double *out, std::size_t n) {
+    fillUniforms(generator, stream, out, n);
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = utils::inverseNormalCDF(out[i]);
+    }
+}
+
+// Sobol low discrepancy sequence in Gray code order with Joe and Kuo's
+// direction numbers, scrambled by a random digital shift per dimension.
+// Independent shifts give independent randomised replications of the same
+// point set, which is how the error of a quasi-random estimate is measured.
+class SobolSequence {
+  public:
+    static constexpr unsigned maxDimensions = 8;
+    SobolSequence(unsigned dimensions, std::uint64_t seed,
+                  std::uint64_t replication)
+        : m_dimensions(dimensions), m_state(dimensions, 0),
+          m_shift(dimensions, 0) {
+        if (dimensions == 0 || dimensions > maxDimensions) {
+            throw std::invalid_argument(
+                "Sobol sequence supports 1 to 8 dimensions.");
+        }
+        // Primitive polynomial degree s, its coefficients a and the initial
+        // direction integers m for dimensions 2 to 8.
+        static constexpr unsigned degree[] = {1, 2, 3, 3, 4, 4, 5};
+        static constexpr unsigned coefficients[] = {0, 1, 1, 2, 1, 4, 2};
+        static constexpr unsigned initial[][5] = {
+            {1}, {1, 3}, {1, 3, 1}, {1, 1, 1},
+            {1, 1, 3, 3}, {1, 3, 5, 13}, {1, 1, 5, 5, 17}};
+        m_directions.resize(dimensions);
+        for (unsigned k = 0; k < bits; ++k) {
+            m_directions[0][k] = std::uint32_t{1} << (bits - 1 - k);
+        }
+        for (unsigned d = 1; d < dimensions; ++d) {
+            unsigned s = degree[d - 1], a = coefficients[d - 1];
+            auto &v = m_directions[d];
+            for (unsigned k = 0; k < bits; ++k) {
+                if (k < s) {
+                    v[k] = initial[d - 1][k] << (bits - 1 - k);
+                    continue;
+                }
+                v[k] = v[k - s] ^ (v[k - s] >> s);
+                for (unsigned j = 1; j < s; ++j) {
+                    if ((a >> (s - 1 - j)) & 1u) {
+                        v[k] ^= v[k - j];
+                    }
+                }
+            }
+        }
+        Philox4x32 generator(seed);
+        for (unsigned d = 0; d < dimensions; ++d) {
+            m_shift[d] = generator(replication, d)[0];
+        }
+    }
+    unsigned getDimensions() const { return m_dimensions; }
+    // Writes the next point, each coordinate strictly inside (0, 1).
+    void next(double *point) {
+        for (unsigned d = 0; d < m_dimensions; ++d) {
+            point[d] = (static_cast<double>(m_state[d] ^ m_shift[d]) + 0.5) *
+                       0x1.0p-32;
+        }
+        unsigned c = 0;
+        for (std::uint64_t n = m_index; n & 1u; n >>= 1) {
+            ++c;
+        }
+        if (c >= bits) {
+            throw std::out_of_range("Sobol sequence exhausted.");
+        }
+        for (unsigned d = 0; d < m_dimensions; ++d) {
+            m_state[d] ^= m_directions[d][c];
+        }
+        ++m_index;
+    }
+
+  private:
+    static constexpr unsigned bits = 32;
+    unsigned m_dimensions;
+    std::uint64_t m_index{0};
+    std::vector<std::array<std::uint32_t, bits>> m_directions;
+    std::vector<std::uint32_t> m_state;
+    std::vector<std::uint32_t> m_shift;
+};
+
+inline std::uint64_t randomSeed() {
+    std::random_device rD;
+    return (std::uint64_t{rD()} << 32) | rD();
+}
+} // namespace rng
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <options-pricing-engine/Portfolio.hpp>
+#include <options-pricing-engine/Types.hpp>
+#include <vector>
+
+namespace scenario {
+// Spot shocks are relative, so 0.05 is a 5% rally, and must be above -1.
+// Volatility and rate shocks are absolute shifts.
+struct ShockGrid {
+    std::vector<double> spot{0.0};
+    std::vector<double> volatility{0.0};
+    std::vector<double> rate{0.0};
+    std::size_t size() const {
+        return spot.size() * volatility.size() * rate.size();
+    }
+    // count evenly spaced shocks from lo to hi inclusive.
+    static std::vector<double> range(double lo, double hi, std::size_t count);
+};
+
+// Profit and loss of every position at every grid point, relative to the
+// unshocked price from the same model. Values are stored position by
+// position, each a rate by volatility by spot block with the spot shock
+// varying fastest. Cells whose shocked inputs are invalid, and positions
+// that fail to price, are NaN.
+struct PnLCube {
+    std::size_t positions{0};
+    std::size_t spots{0};
+    std::size_t volatilities{0};
+    std::size_t rates{0};
+    std::vector<Price> basePrices;
+    std::vector<double> values;
+
+    std::size_t index(std::size_t position, std::size_t spot,
+                      std::size_t volatility, std::size_t rate) const {
+        return ((position * rates + rate) * volatilities + volatility) *
+                   spots +
+               spot;
+    }
+    double at(std::size_t position, std::size_t spot, std::size_t volatility,
+              std::size_t rate) const {
+        return values[index(position, spot, volatility, rate)];
+    }
+    // Book P&L per grid point in the same rate by volatility by spot
+    // layout, skipping positions that failed to price.
+    std::vector<double> aggregate() const;
+};
+
+// Revalues every position at every grid point on the shared thread pool,
+// sharing the work that does not change across scenarios. Closed form
+// positions are priced through the vectorized batch kernels in blocks of
+// positions by grid points. Each lattice position prices every spot shock
+// of a volatility and rate shock in one rollback of a shared tree, as the
+// strike chain K / (1 + s) scaled by 1 + s, and each finite difference
+// position solves one grid per such shock and interpolates it at the
+// shocked spots. Monte Carlo positions reprice with common random numbers,
+// so their P&L is free of seed noise between grid points, and American
+// positions take one approximation per grid point. The settings supply the
+// default resolutions, the seed, the thread count and an optional surface
+// whose volatility the shocks are applied to.
+PnLCube revalue(const std::vector<portfolio::Position> &positions,
+                const ShockGrid &grid,
+                const portfolio::PortfolioSettings &settings = {});
+} // namespace scenario
@@ -0,0 +1,46 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+class ThreadPool {
+  public:
+    explicit ThreadPool(unsigned workers);
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ~ThreadPool();
+    unsigned getWorkers() const {
+        return static_cast<unsigned>(m_threads.size());
+    }
+    // Runs body(i) for every i in [0, count) and blocks until all are done.
+    // The calling thread takes part, joined by at most maxThreads - 1 workers
+    // (0 means no limit). Indices are dealt round-robin to the threads,
+    // which run their own in increasing order and steal from each other when
+    // they run out, so ordering the work by decreasing cost keeps the
+    // expensive indices from straggling. The body must not depend on which
+    // thread runs it. The first exception thrown by the body is rethrown
+    // here. Calls made from inside a task run inline.
+    void parallelFor(std::size_t count,
+                     const std::function<void(std::size_t)> &body,
+                     unsigned maxThreads = 0);
+    // Process wide pool sized to the hardware.
+    static ThreadPool &shared();
+
+  private:
+    struct Job;
+    void workerLoop();
+    std::vector<std::thread> m_threads;
+    std::mutex m_submitMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::shared_ptr<Job> m_job;
+    std::uint64_t m_generation{0};
+    bool m_stop{false};
+};
+} // namespace parallel
@@ -1,9 +1,10 @@
 #pragma once
+#include <cstdint>
 
 using Rate = double;
 using Price = double;
 using Greek = double;
 namespace options {
-enum class OptionType { Call, Put };
-enum class ExerciseStyle { European, American };
+enum class OptionType : std::uint8_t { Call, Put };
+enum class ExerciseStyle : std::uint8_t { European, American };
 } // namespace options
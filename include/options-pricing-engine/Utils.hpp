@@ -1,18 +1,26 @@
 #pragma once
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <options-pricing-engine/MathKernels.hpp>
 #include <random>
 #include <vector>
 
 namespace utils {
 
-static double stepSize = 1;
-
-inline double normalCDF(double x) {
-    return 0.5 * std::erfc(-x / std::sqrt(2.0));
-}
-inline double normalPDF(double x) {
-    return (1.0 / std::sqrt(2.0 * M_PI)) * std::exp(-0.5 * x * x);
+// Finite difference bumps are this fraction of the bumped input, floored so
+// that inputs at or near zero (rates in particular) still get moved.
+constexpr double relativeStepSize = 1e-2;
+constexpr double minimumRateBump = 1e-4;
+inline double bumpSize(double x, double floor = 1e-8) {
+    return std::max(relativeStepSize * std::fabs(x), floor);
 }
+
+inline double normalCDF(double x) { return math::normalCDF(x); }
+inline double normalPDF(double x) { return math::normalPDF(x); }
+// Inverse of the standard normal CDF for p in (0, 1), Wichura's AS241
+// (PPND16), accurate to about 1e-16.
+inline double inverseNormalCDF(double p) { return math::inverseNormalCDF(p); }
 inline std::vector<double> generateSamples(const int N) {
     std::vector<double> samples(N);
     std::random_device rD;
@@ -23,12 +31,127 @@ inline std::vector<double> generateSamples(const int N) {
     }
     return samples;
 }
+template <math::Accuracy A = math::Accuracy::Exact>
 inline double d1(double S, double K, double r, double sigma, double T,
                  double yield = 0.0) {
-    return (std::log(S / K) + ((r - yield) + 0.5 * sigma * sigma) * T) /
+    return (math::log<A>(S / K) + ((r - yield) + 0.5 * sigma * sigma) * T) /
            (sigma * std::sqrt(T));
 }
 inline double d2(double d1, double sigma, double T) {
     return d1 - sigma * std::sqrt(T);
 }
+
+// Running mean and variance. Single samples use Welford's update and whole
+// blocks are folded in with Chan's pairwise merge, so memory stays constant
+// however many samples are streamed through.
+class RunningStats {
+  public:
+    void add(double x) {
+        ++m_count;
+        double delta = x - m_mean;
+        m_mean += delta / m_count;
+        m_m2 += delta * (x - m_mean);
+    }
+    void addBlock(const double *values, std::size_t n) {
+        if (n == 0) {
+            return;
+        }
+        RunningStats block;
+        double sum = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += values[i];
+        }
+        block.m_count = n;
+        block.m_mean = sum / n;
+        for (std::size_t i = 0; i < n; ++i) {
+            double delta = values[i] - block.m_mean;
+            block.m_m2 += delta * delta;
+        }
+        merge(block);
+    }
+    void merge(const RunningStats &other) {
+        if (other.m_count == 0) {
+            return;
+        }
+        std::size_t count = m_count + other.m_count;
+        double delta = other.m_mean - m_mean;
+        m_mean += delta * other.m_count / count;
+        m_m2 += other.m_m2 +
+                delta * delta * (static_cast<double>(m_count) *
+                                 other.m_count / count);
+        m_count = count;
+    }
+    std::size_t count() const { return m_count; }
+    double mean() const { return m_mean; }
+    // Unbiased sample variance.
+    double variance() const {
+        return m_count > 1 ? m_m2 / (m_count - 1) : 0.0;
+    }
+
+  private:
+    std::size_t m_count{0};
+    double m_mean{0.0};
+    double m_m2{0.0};
+};
+
+// Running means, variances and covariance of paired samples, mergeable in
+// the same way as RunningStats.
+class RunningCovariance {
+  public:
+    void addBlock(const double *x, const double *y, std::size_t n) {
+        if (n == 0) {
+            return;
+        }
+        RunningCovariance block;
+        double sumX = 0.0, sumY = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sumX += x[i];
+            sumY += y[i];
+        }
+        block.m_count = n;
+        block.m_meanX = sumX / n;
+        block.m_meanY = sumY / n;
+        for (std::size_t i = 0; i < n; ++i) {
+            double dx = x[i] - block.m_meanX, dy = y[i] - block.m_meanY;
+            block.m_m2X += dx * dx;
+            block.m_m2Y += dy * dy;
+            block.m_cXY += dx * dy;
+        }
+        merge(block);
+    }
+    void merge(const RunningCovariance &other) {
+        if (other.m_count == 0) {
+            return;
+        }
+        std::size_t count = m_count + other.m_count;
+        double dx = other.m_meanX - m_meanX, dy = other.m_meanY - m_meanY;
+        double weight = static_cast<double>(m_count) * other.m_count / count;
+        m_meanX += dx * other.m_count / count;
+        m_meanY += dy * other.m_count / count;
+        m_m2X += other.m_m2X + dx * dx * weight;
+        m_m2Y += other.m_m2Y + dy * dy * weight;
+        m_cXY += other.m_cXY + dx * dy * weight;
+        m_count = count;
+    }
+    std::size_t count() const { return m_count; }
+    double meanX() const { return m_meanX; }
+    double meanY() const { return m_meanY; }
+    double varianceX() const {
+        return m_count > 1 ? m_m2X / (m_count - 1) : 0.0;
+    }
+    double varianceY() const {
+        return m_count > 1 ? m_m2Y / (m_count - 1) : 0.0;
+    }
+    double covariance() const {
+        return m_count > 1 ? m_cXY / (m_count - 1) : 0.0;
+    }
+
+  private:
+    std::size_t m_count{0};
+    double m_meanX{0.0};
+    double m_meanY{0.0};
+    double m_m2X{0.0};
+    double m_m2Y{0.0};
+    double m_cXY{0.0};
+};
 } // namespace utils
\ No newline at end of file
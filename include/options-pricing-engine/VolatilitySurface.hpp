@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <options-pricing-engine/Batch.hpp>
+#include <options-pricing-engine/Option.hpp>
+#include <options-pricing-engine/Types.hpp>
+#include <vector>
+
+namespace surface {
+struct Market {
+    Price spot{0.0};
+    Rate interestRate{0.0};
+    Rate yield{0.0};
+};
+
+// Implied volatility surface fitted to a strike by expiry grid of quotes.
+// Each expiry holds a natural cubic spline of total variance w = sigma^2 T
+// in log forward moneyness k = log(K / F), stored as flat polynomial
+// segments so a lookup is two binary searches and two cubic evaluations.
+// Between expiries w is interpolated linearly in maturity at fixed k; before
+// the first and after the last expiry the volatility of the nearest one is
+// kept, as it is beyond the outermost strikes. Lookups only read, so a
+// surface can be queried from any number of threads.
+class VolatilitySurface {
+  public:
+    // Black-Scholes volatility for a maturity in years and a strike.
+    Rate volatility(double maturity, Price strike) const;
+    double totalVariance(double maturity, double logMoneyness) const;
+    // The spec with its volatility read from the surface. Its spot, rate and
+    // yield are kept; the surface's own market sets the moneyness.
+    options::ContractSpec apply(options::ContractSpec spec) const;
+    const Market &getMarket() const { return m_market; }
+    // Expiries with at least one usable quote.
+    std::size_t getExpiries() const { return m_slices.size(); }
+
+  private:
+    friend class SurfaceBuilder;
+    // w(k) = c0 + t (c1 + t (c2 + t c3)) with t = k - knot, up to the next
+    // knot.
+    struct Segment {
+        double knot;
+        double c0;
+        double c1;
+        double c2;
+        double c3;
+    };
+    struct Slice {
+        double maturity;
+        std::size_t offset;
+        std::size_t count;
+    };
+    double sliceVariance(const Slice &slice, double logMoneyness) const;
+
+    Market m_market;
+    // Fitted expiries in increasing maturity, with their maturities repeated
+    // contiguously for the search.
+    std::vector<Slice> m_slices;
+    std::vector<double> m_maturities;
+    // One block of up to strikes segments per grid expiry.
+    std::vector<Segment> m_segments;
+};
+
+// Maintains the quote grid behind a surface. Quotes can be replaced one at
+// a time; refresh then inverts only the quotes changed since the previous
+// refresh, in parallel through the batch implied volatility solver, and
+// refits only their expiries. Each refresh publishes a new immutable
+// snapshot, so readers of the previous one are never disturbed.
+class SurfaceBuilder {
+  public:
+    // Maturities in years and strikes must be positive and strictly
+    // increasing.
+    SurfaceBuilder(const Market &market, std::vector<double> maturities,
+                   std::vector<Price> strikes);
+    std::size_t getExpiries() const { return m_maturities.size(); }
+    std::size_t getStrikes() const { return m_strikes.size(); }
+    // A price that is NaN or not positive removes the quote from the fit.
+    void setQuote(std::size_t expiry, std::size_t strike, Price price,
+                  options::OptionType type = options::OptionType::Call);
+    // Invalidates every quote.
+    void setMarket(const Market &market);
+    std::shared_ptr<const VolatilitySurface> refresh();
+    // State of the last refresh. Volatilities of failed quotes are NaN.
+    Rate getImpliedVolatility(std::size_t expiry, std::size_t strike) const;
+    batch::VolatilityStatus getStatus(std::size_t expiry,
+                                      std::size_t strike) const;
+    // Quotes inverted by the last refresh.
+    std::size_t getInverted() const { return m_inverted; }
+
+  private:
+    std::size_t index(std::size_t expiry, std::size_t strike) const;
+    void fit(std::size_t expiry);
+
+    std::vector<double> m_maturities;
+    std::vector<Price> m_strikes;
+    // Row-major expiry by strike grids.
+    std::vector<Price> m_prices;
+    std::vector<options::OptionType> m_types;
+    std::vector<Rate> m_volatilities;
+    std::vector<batch::VolatilityStatus> m_status;
+    std::vector<bool> m_dirty;
+    std::vector<bool> m_dirtyExpiries;
+    // Fitted knots per expiry.
+    std::vector<std::size_t> m_counts;
+    std::size_t m_inverted{0};
+    VolatilitySurface m_surface;
+};
+} // namespace surface
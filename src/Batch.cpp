@@ -0,0 +1,559 @@
+#include "BatchKernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <options-pricing-engine/Batch.hpp>
+#include <options-pricing-engine/MathKernels.hpp>
+#include <options-pricing-engine/Model.hpp>
+#include <options-pricing-engine/Option.hpp>
+#include <options-pricing-engine/Types.hpp>
+#include <options-pricing-engine/Utils.hpp>
+#include <stdexcept>
+#include <string>
+
+namespace batch {
+OptionBook::OptionBook(std::size_t capacity) { reserve(capacity); }
+
+void OptionBook::add(const options::Option &option) {
+    add(option.getSpotPrice(), option.getStrikePrice(),
+        option.getInterestRate(), option.getMaturity(),
+        option.getVolatility(), option.getType(), option.getStyle(),
+        option.getYield());
+}
+
+void OptionBook::add(Price spotPrice, Price strikePrice, Rate interestRate,
+                     double maturity, Rate volatility, options::OptionType type,
+                     options::ExerciseStyle style, Rate yield) {
+    if (spotPrice <= 0.0 || strikePrice <= 0.0 || volatility <= 0.0 ||
+        maturity <= 0.0) {
+        throw std::invalid_argument("Spot price, strike price, volatility and "
+                                    "maturity must be positive values.");
+    }
+    m_spot.push_back(spotPrice);
+    m_strike.push_back(strikePrice);
+    m_interestRate.push_back(interestRate);
+    m_volatility.push_back(volatility);
+    m_maturity.push_back(maturity);
+    m_yield.push_back(yield);
+    m_type.push_back(type);
+    m_style.push_back(style);
+}
+
+void OptionBook::reserve(std::size_t capacity) {
+    m_spot.reserve(capacity);
+    m_strike.reserve(capacity);
+    m_interestRate.reserve(capacity);
+    m_volatility.reserve(capacity);
+    m_maturity.reserve(capacity);
+    m_yield.reserve(capacity);
+    m_type.reserve(capacity);
+    m_style.reserve(capacity);
+}
+
+void OptionBook::clear() {
+    m_spot.clear();
+    m_strike.clear();
+    m_interestRate.clear();
+    m_volatility.clear();
+    m_maturity.clear();
+    m_yield.clear();
+    m_type.clear();
+    m_style.clear();
+}
+
+OptionBookView OptionBook::view() const {
+    return {m_spot.data(),     m_strike.data(), m_interestRate.data(),
+            m_volatility.data(), m_maturity.data(), m_yield.data(),
+            m_type.data(),     m_style.data(),  m_spot.size()};
+}
+
+SimdLevel detectSimdLevel() {
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+    (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (detail::hasAvx512Kernels() && __builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512dq")) {
+        return SimdLevel::AVX512;
+    }
+    if (detail::hasAvx2Kernels() && __builtin_cpu_supports("avx2") &&
+        __builtin_cpu_supports("fma")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+const char *toString(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar:
+        return "scalar";
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::AVX512:
+        return "avx512";
+    default:
+        throw std::invalid_argument("Unknown SIMD level.");
+    }
+}
+
+namespace {
+SimdLevel supportedSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+void validate(const OptionBookView &book, const Price *prices) {
+    if (book.size == 0) {
+        return;
+    }
+    if (!book.spot || !book.strike || !book.interestRate ||
+        !book.volatility || !book.maturity || !book.yield || !book.type ||
+        !prices) {
+        throw std::invalid_argument("Option book columns cannot be null.");
+    }
+    if (book.style) {
+        for (std::size_t i = 0; i < book.size; ++i) {
+            if (book.style[i] == options::ExerciseStyle::American) {
+                throw std::invalid_argument(
+                    "Option exercise style must be European");
+            }
+        }
+    }
+}
+
+void checkSimdLevel(SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(supportedSimdLevel())) {
+        throw std::invalid_argument(
+            std::string("SIMD level ") + toString(level) +
+            " is not supported on this machine.");
+    }
+}
+
+template <math::Accuracy A>
+void priceScalar(const OptionBookView &book, std::size_t begin,
+                 Price *prices) {
+    for (std::size_t i = begin; i < book.size; ++i) {
+        Price S = book.spot[i];
+        Price K = book.strike[i];
+        Rate r = book.interestRate[i];
+        double T = book.maturity[i];
+        Rate sigma = book.volatility[i];
+        Rate yield = book.yield[i];
+        double sign = book.type[i] == options::OptionType::Call ? 1.0 : -1.0;
+        double d1 = utils::d1<A>(S, K, r, sigma, T, yield);
+        double d2 = utils::d2(d1, sigma, T);
+        prices[i] = sign * (S * math::exp<A>(-yield * T) *
+                                math::normalCDF<A>(sign * d1) -
+                            K * math::exp<A>(-r * T) *
+                                math::normalCDF<A>(sign * d2));
+    }
+}
+
+template <math::Accuracy A>
+void evaluateScalar(MathFunction function, const double *x, double *result,
+                    std::size_t begin, std::size_t n) {
+    auto elements = [&](auto kernel) {
+        for (std::size_t i = begin; i < n; ++i) {
+            result[i] = kernel(x[i]);
+        }
+    };
+    switch (function) {
+    case MathFunction::Exp:
+        return elements([](double v) { return math::exp<A>(v); });
+    case MathFunction::Log:
+        return elements([](double v) { return math::log<A>(v); });
+    case MathFunction::NormalCDF:
+        return elements([](double v) { return math::normalCDF<A>(v); });
+    case MathFunction::NormalPDF:
+        return elements([](double v) { return math::normalPDF<A>(v); });
+    case MathFunction::InverseNormalCDF:
+        return elements(
+            [](double v) { return math::inverseNormalCDF<A>(v); });
+    default:
+        throw std::invalid_argument("Unknown math function.");
+    }
+}
+} // namespace
+
+void priceBlackScholes(const OptionBookView &book, Price *prices) {
+    priceBlackScholes(book, prices, supportedSimdLevel());
+}
+
+void priceBlackScholes(const OptionBookView &book, Price *prices,
+                       math::Accuracy accuracy) {
+    priceBlackScholes(book, prices, supportedSimdLevel(), accuracy);
+}
+
+void priceBlackScholes(const OptionBookView &book, Price *prices,
+                       SimdLevel level, math::Accuracy accuracy) {
+    validate(book, prices);
+    checkSimdLevel(level);
+    std::size_t tail = 0;
+    switch (level) {
+    case SimdLevel::AVX512:
+        tail = detail::priceBlackScholesAvx512(book, prices, accuracy);
+        break;
+    case SimdLevel::AVX2:
+        tail = detail::priceBlackScholesAvx2(book, prices, accuracy);
+        break;
+    case SimdLevel::Scalar:
+        break;
+    default:
+        throw std::invalid_argument("Unknown SIMD level.");
+    }
+    math::dispatch(accuracy, [&](auto accuracy) {
+        priceScalar<accuracy()>(book, tail, prices);
+    });
+}
+
+namespace detail {
+void priceChainScalar(const ChainTree &tree, const double *strikes,
+                      std::size_t count, Price *prices) {
+    chainBlocks<Scalar>(tree, strikes, count, prices);
+}
+} // namespace detail
+
+void priceBinomialChain(const options::ContractSpec &spec,
+                        const Price *strikes, std::size_t count, int steps,
+                        Price *prices) {
+    priceBinomialChain(spec, strikes, count, steps, prices,
+                       supportedSimdLevel());
+}
+
+void priceBinomialChain(const options::ContractSpec &spec,
+                        const Price *strikes, std::size_t count, int steps,
+                        Price *prices, SimdLevel level) {
+    if (count > 0 && (!strikes || !prices)) {
+        throw std::invalid_argument("Strikes and prices cannot be null.");
+    }
+    checkSimdLevel(level);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!(strikes[i] > 0.0)) {
+            throw std::invalid_argument("Strike prices must be positive.");
+        }
+    }
+    const model::Lattice lattice = model::binomialLattice(spec, steps);
+    if (count == 0) {
+        return;
+    }
+    // Node spots as binomialPrice computes them, and the strikes padded to
+    // whole tiles with copies of the last one.
+    const double sign = spec.type == options::OptionType::Call ? 1.0 : -1.0;
+    const double logUptick = std::log(lattice.uptick);
+    const std::size_t tile = detail::chainTileWidth;
+    const std::size_t padded = (count + tile - 1) / tile * tile;
+    Column<double> spots(2 * steps + 1);
+    for (int k = 0; k <= 2 * steps; ++k) {
+        spots[k] = sign * spec.spotPrice * std::exp((k - steps) * logUptick);
+    }
+    Column<double> signedStrikes(padded);
+    for (std::size_t i = 0; i < padded; ++i) {
+        signedStrikes[i] = sign * strikes[std::min(i, count - 1)];
+    }
+    Column<double> values((steps + 1) * tile);
+    Column<Price> chainPrices(padded);
+    detail::ChainTree tree{spots.data(),
+                           values.data(),
+                           lattice.discount * lattice.probability,
+                           lattice.discount * (1.0 - lattice.probability),
+                           steps,
+                           spec.style == options::ExerciseStyle::American};
+    switch (level) {
+    case SimdLevel::AVX512:
+        detail::priceChainAvx512(tree, signedStrikes.data(), padded,
+                                 chainPrices.data());
+        break;
+    case SimdLevel::AVX2:
+        detail::priceChainAvx2(tree, signedStrikes.data(), padded,
+                               chainPrices.data());
+        break;
+    case SimdLevel::Scalar:
+        detail::priceChainScalar(tree, signedStrikes.data(), padded,
+                                 chainPrices.data());
+        break;
+    default:
+        throw std::invalid_argument("Unknown SIMD level.");
+    }
+    std::copy(chainPrices.begin(), chainPrices.begin() + count, prices);
+}
+
+const char *toString(MathFunction function) {
+    switch (function) {
+    case MathFunction::Exp:
+        return "exp";
+    case MathFunction::Log:
+        return "log";
+    case MathFunction::NormalCDF:
+        return "normal_cdf";
+    case MathFunction::NormalPDF:
+        return "normal_pdf";
+    case MathFunction::InverseNormalCDF:
+        return "inverse_normal_cdf";
+    default:
+        return "unknown";
+    }
+}
+
+void evaluate(MathFunction function, const double *x, double *result,
+              std::size_t n, math::Accuracy accuracy) {
+    evaluate(function, x, result, n, accuracy, supportedSimdLevel());
+}
+
+void evaluate(MathFunction function, const double *x, double *result,
+              std::size_t n, math::Accuracy accuracy, SimdLevel level) {
+    if (n > 0 && (!x || !result)) {
+        throw std::invalid_argument("Math kernel arrays cannot be null.");
+    }
+    checkSimdLevel(level);
+    std::size_t tail = 0;
+    switch (level) {
+    case SimdLevel::AVX512:
+        tail = detail::evaluateAvx512(function, x, result, n, accuracy);
+        break;
+    case SimdLevel::AVX2:
+        tail = detail::evaluateAvx2(function, x, result, n, accuracy);
+        break;
+    case SimdLevel::Scalar:
+        break;
+    default:
+        throw std::invalid_argument("Unknown SIMD level.");
+    }
+    math::dispatch(accuracy, [&](auto accuracy) {
+        evaluateScalar<accuracy()>(function, x, result, tail, n);
+    });
+}
+
+const char *toString(VolatilityStatus status) {
+    switch (status) {
+    case VolatilityStatus::Converged:
+        return "converged";
+    case VolatilityStatus::InvalidInput:
+        return "invalid input";
+    case VolatilityStatus::BelowIntrinsic:
+        return "below intrinsic value";
+    case VolatilityStatus::AboveMaximum:
+        return "above maximum";
+    case VolatilityStatus::NotConverged:
+        return "not converged";
+    default:
+        throw std::invalid_argument("Unknown volatility status.");
+    }
+}
+
+namespace {
+// Quotes are solved in chunks small enough for the scratch to stay in L1.
+// The chunk is a multiple of every vector width, and unused lanes repeat the
+// first quote of the chunk.
+constexpr std::size_t volatilityChunk = 128;
+
+struct VolatilityScratch {
+    alignas(64) double spot[volatilityChunk];
+    alignas(64) double strikePrice[volatilityChunk];
+    alignas(64) double interestRate[volatilityChunk];
+    alignas(64) double yield[volatilityChunk];
+    alignas(64) double maturity[volatilityChunk];
+    alignas(64) double price[volatilityChunk];
+    alignas(64) double sign[volatilityChunk];
+    alignas(64) double forward[volatilityChunk];
+    alignas(64) double strike[volatilityChunk];
+    alignas(64) double logMoneyness[volatilityChunk];
+    alignas(64) double sqrtMaturity[volatilityChunk];
+    alignas(64) double target[volatilityChunk];
+    alignas(64) double headroom[volatilityChunk];
+    alignas(64) double totalVolatility[volatilityChunk];
+    alignas(64) double step[volatilityChunk];
+    std::size_t row[volatilityChunk];
+    std::size_t size{0};
+
+    detail::VolatilityQuotes quotes() {
+        return {spot,
+                strikePrice,
+                interestRate,
+                yield,
+                maturity,
+                price,
+                sign,
+                forward,
+                strike,
+                logMoneyness,
+                sqrtMaturity,
+                target,
+                headroom,
+                totalVolatility,
+                step,
+                (size + 7) / 8 * 8};
+    }
+    void pad(void (VolatilityScratch::*copy)(std::size_t, std::size_t)) {
+        for (std::size_t j = size; j < (size + 7) / 8 * 8; ++j) {
+            (this->*copy)(0, j);
+        }
+    }
+    void copyContract(std::size_t from, std::size_t to) {
+        spot[to] = spot[from];
+        strikePrice[to] = strikePrice[from];
+        interestRate[to] = interestRate[from];
+        yield[to] = yield[from];
+        maturity[to] = maturity[from];
+        price[to] = price[from];
+        sign[to] = sign[from];
+    }
+    void copyPrepared(std::size_t from, std::size_t to) {
+        sign[to] = sign[from];
+        forward[to] = forward[from];
+        strike[to] = strike[from];
+        logMoneyness[to] = logMoneyness[from];
+        sqrtMaturity[to] = sqrtMaturity[from];
+        target[to] = target[from];
+        totalVolatility[to] = totalVolatility[from];
+        row[to] = row[from];
+    }
+};
+
+void prepareQuotes(const detail::VolatilityQuotes &quotes,
+                   const VolatilitySolverSettings &settings, SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX512:
+        detail::prepareQuotesAvx512(quotes, settings);
+        break;
+    case SimdLevel::AVX2:
+        detail::prepareQuotesAvx2(quotes, settings);
+        break;
+    case SimdLevel::Scalar:
+        detail::prepareQuotesScalar(quotes, settings);
+        break;
+    default:
+        throw std::invalid_argument("Unknown SIMD level.");
+    }
+}
+
+void solveQuotes(const detail::VolatilityQuotes &quotes,
+                 const VolatilitySolverSettings &settings, SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX512:
+        detail::solveQuotesAvx512(quotes, settings);
+        break;
+    case SimdLevel::AVX2:
+        detail::solveQuotesAvx2(quotes, settings);
+        break;
+    case SimdLevel::Scalar:
+        detail::solveQuotesScalar(quotes, settings);
+        break;
+    default:
+        throw std::invalid_argument("Unknown SIMD level.");
+    }
+}
+
+// Appends a quote whose inputs can be priced at all; the no-arbitrage bounds
+// are checked once the chunk has been prepared.
+bool gatherQuote(const OptionBookView &book, std::size_t i,
+                 Price marketPrice, VolatilityScratch &scratch) {
+    bool american =
+        book.style && book.style[i] == options::ExerciseStyle::American;
+    if (!(book.spot[i] > 0.0 && book.strike[i] > 0.0 &&
+          book.maturity[i] > 0.0 && marketPrice > 0.0) ||
+        !std::isfinite(book.interestRate[i]) ||
+        !std::isfinite(book.yield[i]) || american) {
+        return false;
+    }
+    std::size_t j = scratch.size++;
+    scratch.spot[j] = book.spot[i];
+    scratch.strikePrice[j] = book.strike[i];
+    scratch.interestRate[j] = book.interestRate[i];
+    scratch.yield[j] = book.yield[i];
+    scratch.maturity[j] = book.maturity[i];
+    scratch.price[j] = marketPrice;
+    scratch.sign[j] = book.type[i] == options::OptionType::Call ? 1.0 : -1.0;
+    scratch.row[j] = i;
+    return true;
+}
+
+void solveScratch(VolatilityScratch &scratch,
+                  const VolatilitySolverSettings &settings, SimdLevel level,
+                  Rate *volatilities, VolatilityStatus *status) {
+    if (scratch.size == 0) {
+        return;
+    }
+    scratch.pad(&VolatilityScratch::copyContract);
+    prepareQuotes(scratch.quotes(), settings, level);
+    // Quotes outside the no-arbitrage bounds are reported and dropped, and
+    // the rest compacted so that no lanes are spent on them. A time value
+    // below the smallest normal double carries no information about
+    // volatility.
+    std::size_t solvable = 0;
+    for (std::size_t j = 0; j < scratch.size; ++j) {
+        if (!(scratch.target[j] >= std::numeric_limits<Price>::min())) {
+            status[scratch.row[j]] = VolatilityStatus::BelowIntrinsic;
+        } else if (!(scratch.headroom[j] > 0.0)) {
+            status[scratch.row[j]] = VolatilityStatus::AboveMaximum;
+        } else {
+            scratch.copyPrepared(j, solvable++);
+        }
+    }
+    scratch.size = solvable;
+    if (solvable > 0) {
+        scratch.pad(&VolatilityScratch::copyPrepared);
+        solveQuotes(scratch.quotes(), settings, level);
+    }
+    for (std::size_t j = 0; j < solvable; ++j) {
+        std::size_t i = scratch.row[j];
+        double w = scratch.totalVolatility[j];
+        double sqrtT = scratch.sqrtMaturity[j];
+        if (w >= settings.maxVolatility * sqrtT * (1.0 - 1e-12)) {
+            status[i] = VolatilityStatus::AboveMaximum;
+            continue;
+        }
+        volatilities[i] = w / sqrtT;
+        status[i] = scratch.step[j] <= settings.tolerance * sqrtT
+                        ? VolatilityStatus::Converged
+                        : VolatilityStatus::NotConverged;
+    }
+    scratch.size = 0;
+}
+} // namespace
+
+namespace detail {
+void prepareQuotesScalar(const VolatilityQuotes &quotes,
+                         const VolatilitySolverSettings &settings) {
+    prepareBlocks<Scalar>(quotes, settings);
+}
+void solveQuotesScalar(const VolatilityQuotes &quotes,
+                       const VolatilitySolverSettings &settings) {
+    solveBlocks<Scalar>(quotes, settings);
+}
+} // namespace detail
+
+void impliedVolatility(const OptionBookView &book, const Price *marketPrices,
+                       Rate *volatilities, VolatilityStatus *status,
+                       const VolatilitySolverSettings &settings) {
+    impliedVolatility(book, marketPrices, volatilities, status, settings,
+                      supportedSimdLevel());
+}
+
+void impliedVolatility(const OptionBookView &book, const Price *marketPrices,
+                       Rate *volatilities, VolatilityStatus *status,
+                       const VolatilitySolverSettings &settings,
+                       SimdLevel level) {
+    if (book.size > 0 &&
+        (!book.spot || !book.strike || !book.interestRate || !book.maturity ||
+         !book.yield || !book.type || !marketPrices || !volatilities ||
+         !status)) {
+        throw std::invalid_argument("Option book columns cannot be null.");
+    }
+    if (!(settings.maxVolatility > 0.0 && settings.tolerance > 0.0 &&
+          settings.maxIterations > 0)) {
+        throw std::invalid_argument(
+            "Volatility solver settings must be positive.");
+    }
+    checkSimdLevel(level);
+    VolatilityScratch scratch;
+    for (std::size_t i = 0; i < book.size; ++i) {
+        volatilities[i] = std::numeric_limits<Rate>::quiet_NaN();
+        if (!gatherQuote(book, i, marketPrices[i], scratch)) {
+            status[i] = VolatilityStatus::InvalidInput;
+        } else if (scratch.size == volatilityChunk) {
+            solveScratch(scratch, settings, level, volatilities, status);
+        }
+    }
+    solveScratch(scratch, settings, level, volatilities, status);
+}
+} // namespace batch
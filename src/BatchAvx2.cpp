@@ -0,0 +1,121 @@
+#include "BatchKernels.hpp"
+#include <options-pricing-engine/Batch.hpp>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <cstring>
+#include <immintrin.h>
+
+namespace batch::detail {
+namespace {
+struct Avx2 {
+    static constexpr std::size_t width = 4;
+    __m256d v;
+
+    static Avx2 broadcast(double x) { return {_mm256_set1_pd(x)}; }
+    static Avx2 load(const double *ptr) { return {_mm256_loadu_pd(ptr)}; }
+    static Avx2 loadSign(const options::OptionType *ptr) {
+        std::int32_t packed;
+        std::memcpy(&packed, ptr, sizeof(packed));
+        __m256i type = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(packed));
+        __m256d isCall = _mm256_castsi256_pd(
+            _mm256_cmpeq_epi64(type, _mm256_setzero_si256()));
+        return {_mm256_blendv_pd(_mm256_set1_pd(-1.0), _mm256_set1_pd(1.0),
+                                 isCall)};
+    }
+    void store(double *ptr) const { _mm256_storeu_pd(ptr, v); }
+
+    friend Avx2 operator+(Avx2 a, Avx2 b) { return {_mm256_add_pd(a.v, b.v)}; }
+    friend Avx2 operator-(Avx2 a, Avx2 b) { return {_mm256_sub_pd(a.v, b.v)}; }
+    friend Avx2 operator*(Avx2 a, Avx2 b) { return {_mm256_mul_pd(a.v, b.v)}; }
+    friend Avx2 operator/(Avx2 a, Avx2 b) { return {_mm256_div_pd(a.v, b.v)}; }
+    friend __m256d operator<(Avx2 a, Avx2 b) {
+        return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ);
+    }
+    friend __m256d operator>(Avx2 a, Avx2 b) {
+        return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ);
+    }
+
+    static Avx2 fma(Avx2 a, Avx2 b, Avx2 c) {
+        return {_mm256_fmadd_pd(a.v, b.v, c.v)};
+    }
+    static Avx2 sqrt(Avx2 a) { return {_mm256_sqrt_pd(a.v)}; }
+    static Avx2 abs(Avx2 a) {
+        return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)};
+    }
+    static Avx2 min(Avx2 a, Avx2 b) { return {_mm256_min_pd(a.v, b.v)}; }
+    static Avx2 max(Avx2 a, Avx2 b) { return {_mm256_max_pd(a.v, b.v)}; }
+    static Avx2 select(__m256d mask, Avx2 a, Avx2 b) {
+        return {_mm256_blendv_pd(b.v, a.v, mask)};
+    }
+    static Avx2 round(Avx2 a) {
+        return {_mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT |
+                                         _MM_FROUND_NO_EXC)};
+    }
+    // Builds 2^n from the biased exponent; n is integral and within the
+    // normal range after exp clamps its argument.
+    static Avx2 ldexp(Avx2 a, Avx2 n) {
+        const __m256d magic = _mm256_set1_pd(6755399441055744.0 + 1023.0);
+        __m256i bits = _mm256_castpd_si256(_mm256_add_pd(n.v, magic));
+        __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(bits, 52));
+        return {_mm256_mul_pd(a.v, scale)};
+    }
+    static Avx2 frexp(Avx2 a, Avx2 &exponent) {
+        const __m256i mantissaMask = _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL);
+        const __m256i one = _mm256_set1_epi64x(0x3FF0000000000000LL);
+        const __m256i twoPow52 = _mm256_set1_epi64x(0x4330000000000000LL);
+        __m256i bits = _mm256_castpd_si256(a.v);
+        __m256i biased = _mm256_srli_epi64(bits, 52);
+        exponent = {_mm256_sub_pd(
+            _mm256_castsi256_pd(_mm256_or_si256(biased, twoPow52)),
+            _mm256_set1_pd(4503599627370496.0 + 1023.0))};
+        return {_mm256_castsi256_pd(
+            _mm256_or_si256(_mm256_and_si256(bits, mantissaMask), one))};
+    }
+};
+} // namespace
+
+bool hasAvx2Kernels() { return true; }
+std::size_t priceBlackScholesAvx2(const OptionBookView &book, Price *prices,
+                                  math::Accuracy accuracy) {
+    return priceBlocks<Avx2>(book, prices, accuracy);
+}
+std::size_t evaluateAvx2(MathFunction function, const double *x,
+                         double *result, std::size_t n,
+                         math::Accuracy accuracy) {
+    return evaluateBlocks<Avx2>(function, x, result, n, accuracy);
+}
+void prepareQuotesAvx2(const VolatilityQuotes &quotes,
+                       const VolatilitySolverSettings &settings) {
+    prepareBlocks<Avx2>(quotes, settings);
+}
+void solveQuotesAvx2(const VolatilityQuotes &quotes,
+                     const VolatilitySolverSettings &settings) {
+    solveBlocks<Avx2>(quotes, settings);
+}
+void priceChainAvx2(const ChainTree &tree, const double *strikes,
+                    std::size_t count, Price *prices) {
+    chainBlocks<Avx2>(tree, strikes, count, prices);
+}
+} // namespace batch::detail
+
+#else
+
+namespace batch::detail {
+bool hasAvx2Kernels() { return false; }
+std::size_t priceBlackScholesAvx2(const OptionBookView &, Price *,
+                                  math::Accuracy) {
+    return 0;
+}
+std::size_t evaluateAvx2(MathFunction, const double *, double *, std::size_t,
+                         math::Accuracy) {
+    return 0;
+}
+void prepareQuotesAvx2(const VolatilityQuotes &,
+                       const VolatilitySolverSettings &) {}
+void solveQuotesAvx2(const VolatilityQuotes &,
+                     const VolatilitySolverSettings &) {}
+void priceChainAvx2(const ChainTree &, const double *, std::size_t,
+                    Price *) {}
+} // namespace batch::detail
+
+#endif
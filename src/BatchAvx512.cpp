@@ -0,0 +1,114 @@
+#include "BatchKernels.hpp"
+#include <options-pricing-engine/Batch.hpp>
+
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+#include <cstring>
+#include <immintrin.h>
+
+namespace batch::detail {
+namespace {
+struct Avx512 {
+    static constexpr std::size_t width = 8;
+    __m512d v;
+
+    static Avx512 broadcast(double x) { return {_mm512_set1_pd(x)}; }
+    static Avx512 load(const double *ptr) { return {_mm512_loadu_pd(ptr)}; }
+    static Avx512 loadSign(const options::OptionType *ptr) {
+        std::int64_t packed;
+        std::memcpy(&packed, ptr, sizeof(packed));
+        __m512i type = _mm512_cvtepu8_epi64(_mm_cvtsi64_si128(packed));
+        __mmask8 isCall =
+            _mm512_cmpeq_epi64_mask(type, _mm512_setzero_si512());
+        return {_mm512_mask_blend_pd(isCall, _mm512_set1_pd(-1.0),
+                                     _mm512_set1_pd(1.0))};
+    }
+    void store(double *ptr) const { _mm512_storeu_pd(ptr, v); }
+
+    friend Avx512 operator+(Avx512 a, Avx512 b) {
+        return {_mm512_add_pd(a.v, b.v)};
+    }
+    friend Avx512 operator-(Avx512 a, Avx512 b) {
+        return {_mm512_sub_pd(a.v, b.v)};
+    }
+    friend Avx512 operator*(Avx512 a, Avx512 b) {
+        return {_mm512_mul_pd(a.v, b.v)};
+    }
+    friend Avx512 operator/(Avx512 a, Avx512 b) {
+        return {_mm512_div_pd(a.v, b.v)};
+    }
+    friend __mmask8 operator<(Avx512 a, Avx512 b) {
+        return _mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ);
+    }
+    friend __mmask8 operator>(Avx512 a, Avx512 b) {
+        return _mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ);
+    }
+
+    static Avx512 fma(Avx512 a, Avx512 b, Avx512 c) {
+        return {_mm512_fmadd_pd(a.v, b.v, c.v)};
+    }
+    static Avx512 sqrt(Avx512 a) { return {_mm512_sqrt_pd(a.v)}; }
+    static Avx512 abs(Avx512 a) { return {_mm512_abs_pd(a.v)}; }
+    static Avx512 min(Avx512 a, Avx512 b) { return {_mm512_min_pd(a.v, b.v)}; }
+    static Avx512 max(Avx512 a, Avx512 b) { return {_mm512_max_pd(a.v, b.v)}; }
+    static Avx512 select(__mmask8 mask, Avx512 a, Avx512 b) {
+        return {_mm512_mask_blend_pd(mask, b.v, a.v)};
+    }
+    static Avx512 round(Avx512 a) {
+        return {_mm512_roundscale_pd(a.v, _MM_FROUND_TO_NEAREST_INT |
+                                              _MM_FROUND_NO_EXC)};
+    }
+    static Avx512 ldexp(Avx512 a, Avx512 n) {
+        return {_mm512_scalef_pd(a.v, n.v)};
+    }
+    static Avx512 frexp(Avx512 a, Avx512 &exponent) {
+        exponent = {_mm512_getexp_pd(a.v)};
+        return {_mm512_getmant_pd(a.v, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_src)};
+    }
+};
+} // namespace
+
+bool hasAvx512Kernels() { return true; }
+std::size_t priceBlackScholesAvx512(const OptionBookView &book, Price *prices,
+                                    math::Accuracy accuracy) {
+    return priceBlocks<Avx512>(book, prices, accuracy);
+}
+std::size_t evaluateAvx512(MathFunction function, const double *x,
+                           double *result, std::size_t n,
+                           math::Accuracy accuracy) {
+    return evaluateBlocks<Avx512>(function, x, result, n, accuracy);
+}
+void prepareQuotesAvx512(const VolatilityQuotes &quotes,
+                         const VolatilitySolverSettings &settings) {
+    prepareBlocks<Avx512>(quotes, settings);
+}
+void solveQuotesAvx512(const VolatilityQuotes &quotes,
+                       const VolatilitySolverSettings &settings) {
+    solveBlocks<Avx512>(quotes, settings);
+}
+void priceChainAvx512(const ChainTree &tree, const double *strikes,
+                      std::size_t count, Price *prices) {
+    chainBlocks<Avx512>(tree, strikes, count, prices);
+}
+} // namespace batch::detail
+
+#else
+
+namespace batch::detail {
+bool hasAvx512Kernels() { return false; }
+std::size_t priceBlackScholesAvx512(const OptionBookView &, Price *,
+                                    math::Accuracy) {
+    return 0;
+}
+std::size_t evaluateAvx512(MathFunction, const double *, double *, std::size_t,
+                           math::Accuracy) {
+    return 0;
+}
+void prepareQuotesAvx512(const VolatilityQuotes &,
+                         const VolatilitySolverSettings &) {}
+void solveQuotesAvx512(const VolatilityQuotes &,
+                       const VolatilitySolverSettings &) {}
+void priceChainAvx512(const ChainTree &, const double *, std::size_t,
+                      Price *) {}
+} // namespace batch::detail
+
+#endif
@@ -0,0 +1,351 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <options-pricing-engine/Batch.hpp>
+#include <options-pricing-engine/MathKernels.hpp>
+#include <options-pricing-engine/Types.hpp>
+#include <stdexcept>
+
+// Width-generic Black-Scholes kernels shared by the per-instruction-set
+// translation units. Every function is a template over the vector type V so
+// each unit gets its own instantiation compiled with its own target flags.
+// V implements the interface described in math::detail.
+namespace batch::detail {
+// The hasXKernels functions report whether the unit was built with the
+// corresponding instruction set. The pricing and evaluate entry points
+// return the index of the first element left for the scalar tail.
+bool hasAvx2Kernels();
+bool hasAvx512Kernels();
+std::size_t priceBlackScholesAvx2(const OptionBookView &book, Price *prices,
+                                  math::Accuracy accuracy);
+std::size_t priceBlackScholesAvx512(const OptionBookView &book, Price *prices,
+                                    math::Accuracy accuracy);
+std::size_t evaluateAvx2(MathFunction function, const double *x,
+                         double *result, std::size_t n,
+                         math::Accuracy accuracy);
+std::size_t evaluateAvx512(MathFunction function, const double *x,
+                           double *result, std::size_t n,
+                           math::Accuracy accuracy);
+
+// Structure of arrays for a chunk of implied volatility quotes, padded to a
+// multiple of the widest vector. The solver works in total volatility
+// w = sigma sqrt(T), for which the price is sign (F N(sign d1) - K N(sign d2))
+// with d1 = x / w + w / 2, F and K the discounted forward and strike and
+// x = log(F / K).
+//
+// prepareQuotes reads the contract columns and the market price. It writes
+// F, K, x, sqrt(T), the time value as target, the room left below the
+// no-arbitrage upper bound as headroom and an initial guess for w, and flips
+// sign so that every quote is solved as an out of the money option.
+// solveQuotes refines totalVolatility and writes the last step taken.
+struct VolatilityQuotes {
+    double *spot;
+    double *strikePrice;
+    double *interestRate;
+    double *yield;
+    double *maturity;
+    double *price;
+    double *sign;
+    double *forward;
+    double *strike;
+    double *logMoneyness;
+    double *sqrtMaturity;
+    double *target;
+    double *headroom;
+    double *totalVolatility;
+    double *step;
+    std::size_t size;
+};
+void prepareQuotesScalar(const VolatilityQuotes &quotes,
+                         const VolatilitySolverSettings &settings);
+void prepareQuotesAvx2(const VolatilityQuotes &quotes,
+                       const VolatilitySolverSettings &settings);
+void prepareQuotesAvx512(const VolatilityQuotes &quotes,
+                         const VolatilitySolverSettings &settings);
+void solveQuotesScalar(const VolatilityQuotes &quotes,
+                       const VolatilitySolverSettings &settings);
+void solveQuotesAvx2(const VolatilityQuotes &quotes,
+                     const VolatilitySolverSettings &settings);
+void solveQuotesAvx512(const VolatilityQuotes &quotes,
+                       const VolatilitySolverSettings &settings);
+
+// Cox-Ross-Rubinstein tree shared by every strike of a chain. spots holds
+// the 2 steps + 1 node spots S u^k, k in [-steps, steps], and strikes are
+// passed in the same way, both times the payoff sign, so the exercise value
+// of every node is max(spot - strike, 0). values is scratch for steps + 1
+// rows of chainTileWidth strikes.
+struct ChainTree {
+    const double *spots;
+    double *values;
+    double upWeight;
+    double downWeight;
+    int steps;
+    bool american;
+};
+constexpr std::size_t chainTileWidth = 16;
+constexpr int chainLevels = 8;
+// Writes the price of every strike. count must be a multiple of
+// chainTileWidth, so the caller pads the chain and drops the extra prices.
+void priceChainScalar(const ChainTree &tree, const double *strikes,
+                      std::size_t count, Price *prices);
+void priceChainAvx2(const ChainTree &tree, const double *strikes,
+                    std::size_t count, Price *prices);
+void priceChainAvx512(const ChainTree &tree, const double *strikes,
+                      std::size_t count, Price *prices);
+
+using math::detail::exp;
+using math::detail::inverseNormalCDF;
+using math::detail::log;
+using math::detail::normalCDF;
+using math::detail::normalPDF;
+using math::detail::Scalar;
+
+template <typename V, math::Accuracy A>
+inline void blackScholesKernel(const OptionBookView &book, std::size_t i,
+                               Price *prices) {
+    V S = V::load(book.spot + i);
+    V K = V::load(book.strike + i);
+    V r = V::load(book.interestRate + i);
+    V sigma = V::load(book.volatility + i);
+    V T = V::load(book.maturity + i);
+    V q = V::load(book.yield + i);
+    V sign = V::loadSign(book.type + i);
+
+    V volSqrtT = sigma * V::sqrt(T);
+    V d1 = V::fma(r - q + V::broadcast(0.5) * sigma * sigma, T,
+                  log<V, A>(S / K)) /
+           volSqrtT;
+    V d2 = d1 - volSqrtT;
+    V forward = S * exp<V, A>(V::broadcast(0.0) - q * T);
+    V discountedStrike = K * exp<V, A>(V::broadcast(0.0) - r * T);
+    V price = sign * (forward * normalCDF<V, A>(sign * d1) -
+                      discountedStrike * normalCDF<V, A>(sign * d2));
+    price.store(prices + i);
+}
+
+template <typename V>
+inline void prepareKernel(const VolatilityQuotes &quotes, std::size_t i,
+                          const VolatilitySolverSettings &settings) {
+    const V zero = V::broadcast(0.0);
+    const V half = V::broadcast(0.5);
+    V S = V::load(quotes.spot + i);
+    V T = V::load(quotes.maturity + i);
+    V P = V::load(quotes.price + i);
+    V sign = V::load(quotes.sign + i);
+    V sqrtT = V::sqrt(T);
+    V F = S * exp(zero - V::load(quotes.yield + i) * T);
+    V K = V::load(quotes.strikePrice + i) *
+          exp(zero - V::load(quotes.interestRate + i) * T);
+    V x = log(F / K);
+    V intrinsic = V::max(sign * (F - K), zero);
+    V bound = V::select(sign > zero, F, K);
+    // Corrado and Miller's closed form on the call price from put-call
+    // parity, with the discriminant floored at zero. Where it fails, the
+    // inflection point sqrt(2 |x|) of the price in w, from which Newton's
+    // method converges monotonically (Manaster and Koehler).
+    V call = V::select(sign > zero, P, P + F - K);
+    V a = call - half * (F - K);
+    V discriminant = V::max(a * a - (F - K) * (F - K) *
+                                        V::broadcast(0.3183098861837907),
+                            zero);
+    V corradoMiller = V::broadcast(2.5066282746310002) / (F + K) *
+                      (a + V::sqrt(discriminant));
+    V inflection = V::sqrt(V::broadcast(2.0) * V::abs(x));
+    V maxTotal = V::broadcast(settings.maxVolatility) * sqrtT;
+    V guess = V::select(corradoMiller > zero, corradoMiller, inflection);
+    guess = V::select(corradoMiller < maxTotal, guess, inflection);
+    V fallback = half * maxTotal;
+    V start = V::select(guess > zero, guess, fallback);
+    start = V::select(guess < maxTotal, start, fallback);
+
+    F.store(quotes.forward + i);
+    K.store(quotes.strike + i);
+    x.store(quotes.logMoneyness + i);
+    sqrtT.store(quotes.sqrtMaturity + i);
+    (P - intrinsic).store(quotes.target + i);
+    (bound - P).store(quotes.headroom + i);
+    start.store(quotes.totalVolatility + i);
+    V::select(intrinsic > zero, zero - sign, sign).store(quotes.sign + i);
+}
+
+// Safeguarded Halley iteration on the total volatility of V::width out of
+// the money quotes in lock step. The objective is log(price / target), which
+// stays well scaled for small premiums where the price itself is almost
+// flat. Each evaluation narrows the bracket [0, maxVolatility sqrt(T)] and
+// any step that would leave it is replaced by bisection, so lanes whose
+// price underflows still converge. Stops once every lane has moved less
+// than its tolerance.
+template <typename V>
+inline void solveKernel(const VolatilityQuotes &quotes, std::size_t i,
+                        const VolatilitySolverSettings &settings) {
+    const V zero = V::broadcast(0.0);
+    const V half = V::broadcast(0.5);
+    const V one = V::broadcast(1.0);
+    const V invSqrt2Pi = V::broadcast(0.3989422804014327);
+    V logTarget = log(V::load(quotes.target + i));
+    V x = V::load(quotes.logMoneyness + i);
+    V F = V::load(quotes.forward + i);
+    V K = V::load(quotes.strike + i);
+    V sign = V::load(quotes.sign + i);
+    V sqrtT = V::load(quotes.sqrtMaturity + i);
+    V tolerance = V::broadcast(settings.tolerance) * sqrtT;
+    V w = V::load(quotes.totalVolatility + i);
+    V lower = zero;
+    V upper = V::broadcast(settings.maxVolatility) * sqrtT;
+    V step = zero;
+    for (int iteration = 0; iteration < settings.maxIterations; ++iteration) {
+        V d1 = V::fma(half, w, x / w);
+        V d2 = d1 - w;
+        V price = sign * (F * normalCDF(sign * d1) - K * normalCDF(sign * d2));
+        V error = log(price) - logTarget;
+        lower = V::select(error < zero, w, lower);
+        upper = V::select(error > zero, w, upper);
+        // With v = vega / price, the objective has slope v and curvature
+        // v (d1 d2 / w - v).
+        V v = F * invSqrt2Pi * exp(V::broadcast(-0.5) * d1 * d1) / price;
+        V newton = error / v;
+        V curvature = d1 * d2 / w - v;
+        V halley = newton / V::max(one - half * newton * curvature, half);
+        V next = w - halley;
+        V bisection = half * (lower + upper);
+        next = V::select(next > lower, next, bisection);
+        next = V::select(next < upper, next, bisection);
+        step = V::abs(next - w);
+        w = next;
+        double lanes[V::width];
+        V::max(step - tolerance, zero).store(lanes);
+        if (std::all_of(lanes, lanes + V::width,
+                        [](double excess) { return excess == 0.0; })) {
+            break;
+        }
+    }
+    w.store(quotes.totalVolatility + i);
+    step.store(quotes.step + i);
+}
+
+template <typename V>
+inline void prepareBlocks(const VolatilityQuotes &quotes,
+                          const VolatilitySolverSettings &settings) {
+    for (std::size_t i = 0; i < quotes.size; i += V::width) {
+        prepareKernel<V>(quotes, i, settings);
+    }
+}
+
+template <typename V>
+inline void solveBlocks(const VolatilityQuotes &quotes,
+                        const VolatilitySolverSettings &settings) {
+    for (std::size_t i = 0; i < quotes.size; i += V::width) {
+        solveKernel<V>(quotes, i, settings);
+    }
+}
+
+// Backward induction over one tile of chainTileWidth strikes. Each node
+// row holds the tile's strikes side by side, so the strike loop is a few
+// whole vectors. A sweep over the rows advances chainLevels levels at once
+// as a wavefront: at row i it updates level step at i, level step - 1 at
+// i - 1 and so on, each reading rows the sweep has just touched, so a tile
+// deeper than the cache still streams through it once per chainLevels
+// levels.
+template <typename V, bool American>
+inline void chainKernel(const ChainTree &tree, const double *strikes,
+                        Price *prices) {
+    constexpr std::size_t vectors = chainTileWidth / V::width;
+    static_assert(vectors * V::width == chainTileWidth);
+    const int steps = tree.steps;
+    double *values = tree.values;
+    const V zero = V::broadcast(0.0);
+    V strike[vectors];
+    for (std::size_t v = 0; v < vectors; ++v) {
+        strike[v] = V::load(strikes + v * V::width);
+    }
+    for (int index = 0; index <= steps; ++index) {
+        V spot = V::broadcast(tree.spots[2 * index]);
+        double *row = values + index * chainTileWidth;
+        for (std::size_t v = 0; v < vectors; ++v) {
+            V::max(spot - strike[v], zero).store(row + v * V::width);
+        }
+    }
+    const V up = V::broadcast(tree.upWeight);
+    const V down = V::broadcast(tree.downWeight);
+    for (int step = steps - 1; step >= 0; step -= chainLevels) {
+        const int levels = std::min(chainLevels, step + 1);
+        for (int i = 0; i <= step; ++i) {
+            for (int d = 0; d < levels && d <= i; ++d) {
+                const int index = i - d;
+                double *row = values + index * chainTileWidth;
+                V spot = V::broadcast(
+                    tree.spots[steps - step + d + 2 * index]);
+                for (std::size_t v = 0; v < vectors; ++v) {
+                    V value = V::fma(
+                        up, V::load(row + chainTileWidth + v * V::width),
+                        down * V::load(row + v * V::width));
+                    if constexpr (American) {
+                        value = V::max(value, spot - strike[v]);
+                    }
+                    value.store(row + v * V::width);
+                }
+            }
+        }
+    }
+    for (std::size_t v = 0; v < vectors; ++v) {
+        V::load(values + v * V::width).store(prices + v * V::width);
+    }
+}
+
+template <typename V>
+inline void chainBlocks(const ChainTree &tree, const double *strikes,
+                        std::size_t count, Price *prices) {
+    for (std::size_t i = 0; i < count; i += chainTileWidth) {
+        if (tree.american) {
+            chainKernel<V, true>(tree, strikes + i, prices + i);
+        } else {
+            chainKernel<V, false>(tree, strikes + i, prices + i);
+        }
+    }
+}
+
+// Processes the largest multiple of the vector width and returns the index
+// of the first element left for the scalar tail.
+template <typename V>
+inline std::size_t priceBlocks(const OptionBookView &book, Price *prices,
+                               math::Accuracy accuracy) {
+    return math::dispatch(accuracy, [&](auto accuracy) {
+        std::size_t i = 0;
+        for (; i + V::width <= book.size; i += V::width) {
+            blackScholesKernel<V, accuracy()>(book, i, prices);
+        }
+        return i;
+    });
+}
+
+template <typename V>
+inline std::size_t evaluateBlocks(MathFunction function, const double *x,
+                                  double *result, std::size_t n,
+                                  math::Accuracy accuracy) {
+    return math::dispatch(accuracy, [&](auto accuracy) {
+        constexpr math::Accuracy A = accuracy();
+        auto blocks = [&](auto kernel) {
+            std::size_t i = 0;
+            for (; i + V::width <= n; i += V::width) {
+                kernel(V::load(x + i)).store(result + i);
+            }
+            return i;
+        };
+        switch (function) {
+        case MathFunction::Exp:
+            return blocks([](V v) { return exp<V, A>(v); });
+        case MathFunction::Log:
+            return blocks([](V v) { return log<V, A>(v); });
+        case MathFunction::NormalCDF:
+            return blocks([](V v) { return normalCDF<V, A>(v); });
+        case MathFunction::NormalPDF:
+            return blocks([](V v) { return normalPDF<V, A>(v); });
+        case MathFunction::InverseNormalCDF:
+            return blocks([](V v) { return inverseNormalCDF<V, A>(v); });
+        default:
+            throw std::invalid_argument("Unknown math function.");
+        }
+    });
+}
+} // namespace batch::detail
@@ -0,0 +1,212 @@
+#include <cstring>
+#include <fstream>
+#include <options-pricing-engine/Batch.hpp>
+#include <options-pricing-engine/BookFile.hpp>
+#include <options-pricing-engine/Types.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace batch {
+namespace {
+constexpr std::uint32_t byteOrderMark = 0x01020304;
+constexpr std::uint64_t columnAlignment = 64;
+
+std::uint64_t alignUp(std::uint64_t offset) {
+    return (offset + columnAlignment - 1) / columnAlignment *
+           columnAlignment;
+}
+
+std::uint32_t elementSize(BookField field) {
+    switch (field) {
+    case BookField::Type:
+        return sizeof(options::OptionType);
+    case BookField::Style:
+        return sizeof(options::ExerciseStyle);
+    default:
+        return sizeof(double);
+    }
+}
+
+// Column offsets follow from the row count alone, so the writer and the
+// reader lay the file out the same way.
+BookFileHeader makeHeader(std::uint64_t rows) {
+    BookFileHeader header{};
+    std::memcpy(header.magic, bookFileMagic, sizeof(header.magic));
+    header.version = bookFileVersion;
+    header.columnCount = bookFieldCount;
+    header.rows = rows;
+    header.byteOrder = byteOrderMark;
+    std::uint64_t offset = alignUp(sizeof(BookFileHeader));
+    for (std::size_t i = 0; i < bookFieldCount; ++i) {
+        BookField field = static_cast<BookField>(i);
+        header.columns[i] = {field, elementSize(field), offset};
+        offset = alignUp(offset + rows * elementSize(field));
+    }
+    return header;
+}
+
+const void *columnData(const OptionBookView &book, BookField field) {
+    switch (field) {
+    case BookField::Spot:
+        return book.spot;
+    case BookField::Strike:
+        return book.strike;
+    case BookField::InterestRate:
+        return book.interestRate;
+    case BookField::Volatility:
+        return book.volatility;
+    case BookField::Maturity:
+        return book.maturity;
+    case BookField::Yield:
+        return book.yield;
+    case BookField::Type:
+        return book.type;
+    case BookField::Style:
+        return book.style;
+    default:
+        throw std::invalid_argument("Unknown book field.");
+    }
+}
+} // namespace
+
+void writeBookFile(const std::string &path, const OptionBookView &book) {
+    if (book.size > 0 &&
+        (!book.spot || !book.strike || !book.interestRate ||
+         !book.volatility || !book.maturity || !book.yield || !book.type)) {
+        throw std::invalid_argument("Option book columns cannot be null.");
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open book file " + path + ".");
+    }
+    const BookFileHeader header = makeHeader(book.size);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    std::uint64_t position = sizeof(header);
+    const std::vector<options::ExerciseStyle> european(
+        book.style ? 0 : book.size, options::ExerciseStyle::European);
+    const char padding[columnAlignment] = {};
+    for (const BookFileColumn &column : header.columns) {
+        out.write(padding, column.offset - position);
+        const void *data = columnData(book, column.field);
+        if (!data) {
+            data = european.data();
+        }
+        std::uint64_t bytes = book.size * column.elementSize;
+        out.write(static_cast<const char *>(data), bytes);
+        position = column.offset + bytes;
+    }
+    out.write(padding, alignUp(position) - position);
+    if (!out) {
+        throw std::runtime_error("Failed to write book file " + path + ".");
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+MappedOptionBook::MappedOptionBook(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open book file " + path + ".");
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 ||
+        static_cast<std::uint64_t>(status.st_size) < sizeof(BookFileHeader)) {
+        ::close(fd);
+        throw std::runtime_error(path + " is not a book file.");
+    }
+    m_length = static_cast<std::size_t>(status.st_size);
+    m_data = ::mmap(nullptr, m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m_data == MAP_FAILED) {
+        m_data = nullptr;
+        throw std::runtime_error("Cannot map book file " + path + ".");
+    }
+
+    BookFileHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    const BookFileHeader expected = makeHeader(header.rows);
+    bool valid =
+        std::memcmp(header.magic, bookFileMagic, sizeof(header.magic)) == 0 &&
+        header.version == bookFileVersion &&
+        header.byteOrder == byteOrderMark &&
+        header.columnCount == bookFieldCount &&
+        header.rows < (std::uint64_t{1} << 48);
+    for (std::size_t i = 0; valid && i < bookFieldCount; ++i) {
+        const BookFileColumn &column = header.columns[i];
+        valid = column.field == expected.columns[i].field &&
+                column.elementSize == expected.columns[i].elementSize &&
+                column.offset == expected.columns[i].offset &&
+                column.offset + header.rows * column.elementSize <= m_length;
+    }
+    if (!valid) {
+        unmap();
+        throw std::runtime_error(path + " is not a supported book file.");
+    }
+    ::madvise(m_data, m_length, MADV_SEQUENTIAL);
+
+    const char *base = static_cast<const char *>(m_data);
+    auto column = [&](BookField field) {
+        return base + header.columns[static_cast<std::size_t>(field)].offset;
+    };
+    m_view.spot = reinterpret_cast<const Price *>(column(BookField::Spot));
+    m_view.strike = reinterpret_cast<const Price *>(column(BookField::Strike));
+    m_view.interestRate =
+        reinterpret_cast<const Rate *>(column(BookField::InterestRate));
+    m_view.volatility =
+        reinterpret_cast<const Rate *>(column(BookField::Volatility));
+    m_view.maturity =
+        reinterpret_cast<const double *>(column(BookField::Maturity));
+    m_view.yield = reinterpret_cast<const Rate *>(column(BookField::Yield));
+    m_view.type =
+        reinterpret_cast<const options::OptionType *>(column(BookField::Type));
+    m_view.style = reinterpret_cast<const options::ExerciseStyle *>(
+        column(BookField::Style));
+    m_view.size = static_cast<std::size_t>(header.rows);
+}
+
+void MappedOptionBook::unmap() {
+    if (m_data) {
+        ::munmap(m_data, m_length);
+    }
+    m_data = nullptr;
+    m_length = 0;
+    m_view = {};
+}
+#else
+MappedOptionBook::MappedOptionBook(const std::string &) {
+    throw std::runtime_error("Memory mapped book files need a POSIX system.");
+}
+
+void MappedOptionBook::unmap() {}
+#endif
+
+MappedOptionBook::MappedOptionBook(MappedOptionBook &&other) noexcept
+    : m_data(other.m_data), m_length(other.m_length), m_view(other.m_view) {
+    other.m_data = nullptr;
+    other.m_length = 0;
+    other.m_view = {};
+}
+
+MappedOptionBook &
+MappedOptionBook::operator=(MappedOptionBook &&other) noexcept {
+    if (this != &other) {
+        unmap();
+        m_data = other.m_data;
+        m_length = other.m_length;
+        m_view = other.m_view;
+        other.m_data = nullptr;
+        other.m_length = 0;
+        other.m_view = {};
+    }
+    return *this;
+}
+
+MappedOptionBook::~MappedOptionBook() { unmap(); }
+} // namespace batch
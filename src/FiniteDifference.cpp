@@ -0,0 +1,382 @@
+#include <algorithm>
+#include <cmath>
+#include <options-pricing-engine/Model.hpp>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+namespace model {
+namespace {
+constexpr int maxPenaltyIterations = 100;
+constexpr int maxSorIterations = 10000;
+
+// One row per spot node of the discretised operator
+// L V = sigma^2 S^2 / 2 V_SS + (r - q) S V_S - r V.
+struct Operator {
+    std::vector<double> lower;
+    std::vector<double> diagonal;
+    std::vector<double> upper;
+};
+
+// The system I - theta dt L of one time step, with the forward elimination
+// of the Thomas algorithm done once: the eliminated upper diagonal and the
+// inverse pivots.
+struct StepMatrix {
+    double explicitWeight;
+    std::vector<double> lower;
+    std::vector<double> diagonal;
+    std::vector<double> upper;
+    std::vector<double> eliminated;
+    std::vector<double> inversePivot;
+};
+
+void checkInputs(const options::ContractSpec &spec,
+                 const FiniteDifferenceSettings &settings) {
+    if (!(spec.spotPrice > 0.0) || !(spec.strikePrice > 0.0) ||
+        !(spec.maturity > 0.0) || !(spec.volatility > 0.0)) {
+        throw std::invalid_argument(
+            "Spot, strike, maturity and volatility must be positive.");
+    }
+    if (settings.spotNodes < 4 || settings.timeSteps < 1 ||
+        settings.rannacherSteps < 0) {
+        throw std::invalid_argument(
+            "Finite differences need at least 4 spot nodes and 1 time step.");
+    }
+    if (!(settings.width > 0.0) || !(settings.concentration > 0.0) ||
+        !(settings.tolerance > 0.0)) {
+        throw std::invalid_argument(
+            "Grid width, concentration and tolerance must be positive.");
+    }
+    if (!(settings.relaxation > 0.0 && settings.relaxation < 2.0)) {
+        throw std::invalid_argument(
+            "Over-relaxation factor must lie in (0, 2).");
+    }
+}
+
+// Nodes K + c sinh(x) for x uniform, with the step chosen so that the
+// strike, x = 0, is a node and the first node is 0.
+std::vector<Price> spotGrid(const options::ContractSpec &spec,
+                            const FiniteDifferenceSettings &settings) {
+    const int n = settings.spotNodes;
+    const Price K = spec.strikePrice;
+    const double deviation = spec.volatility * std::sqrt(spec.maturity);
+    const double scale = settings.concentration * deviation * K;
+    const Price top =
+        std::max(spec.spotPrice, K) * std::exp(settings.width * deviation);
+    const double low = std::asinh(-K / scale);
+    const double high = std::asinh((top - K) / scale);
+    const int below = std::clamp(
+        static_cast<int>(std::lround(n * -low / (high - low))), 1, n - 2);
+    const double step = -low / below;
+    std::vector<Price> spots(n + 1);
+    for (int i = 0; i <= n; ++i) {
+        spots[i] = K + scale * std::sinh(low + i * step);
+    }
+    spots[0] = 0.0;
+    spots[below] = K;
+    return spots;
+}
+
+// Central differences on the uneven grid. At S = 0 the operator reduces to
+// -r V; at the top, zero gamma leaves the drift, differenced backwards.
+Operator buildOperator(const options::ContractSpec &spec,
+                       const std::vector<Price> &spots) {
+    const std::size_t n = spots.size() - 1;
+    const double r = spec.interestRate;
+    const double carry = spec.interestRate - spec.yield;
+    const double variance = spec.volatility * spec.volatility;
+    Operator L;
+    L.lower.assign(n + 1, 0.0);
+    L.diagonal.assign(n + 1, -r);
+    L.upper.assign(n + 1, 0.0);
+    for (std::size_t i = 1; i < n; ++i) {
+        double down = spots[i] - spots[i - 1];
+        double up = spots[i + 1] - spots[i];
+        double diffusion = variance * spots[i] * spots[i];
+        double drift = carry * spots[i];
+        L.lower[i] = (diffusion - drift * up) / (down * (down + up));
+        L.upper[i] = (diffusion + drift * down) / (up * (down + up));
+        L.diagonal[i] =
+            (-diffusion + drift * (up - down)) / (down * up) - r;
+    }
+    double last = spots[n] - spots[n - 1];
+    L.lower[n] = -carry * spots[n] / last;
+    L.diagonal[n] = carry * spots[n] / last - r;
+    return L;
+}
+
+// Thomas algorithm; scratch holds the eliminated upper diagonal.
+void thomas(const double *lower, const double *diagonal, const double *upper,
+            const double *rhs, double *x, double *scratch, std::size_t size) {
+    scratch[0] = upper[0] / diagonal[0];
+    x[0] = rhs[0] / diagonal[0];
+    for (std::size_t i = 1; i < size; ++i) {
+        double pivot = diagonal[i] - lower[i] * scratch[i - 1];
+        scratch[i] = upper[i] / pivot;
+        x[i] = (rhs[i] - lower[i] * x[i - 1]) / pivot;
+    }
+    for (std::size_t i = size - 1; i-- > 0;) {
+        x[i] -= scratch[i] * x[i + 1];
+    }
+}
+
+StepMatrix stepMatrix(const Operator &L, double theta, double dt) {
+    const std::size_t size = L.lower.size();
+    StepMatrix A;
+    A.explicitWeight = (1.0 - theta) * dt;
+    A.lower.resize(size);
+    A.diagonal.resize(size);
+    A.upper.resize(size);
+    A.eliminated.resize(size);
+    A.inversePivot.resize(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        A.lower[i] = -theta * dt * L.lower[i];
+        A.diagonal[i] = 1.0 - theta * dt * L.diagonal[i];
+        A.upper[i] = -theta * dt * L.upper[i];
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+        double pivot = A.diagonal[i];
+        if (i > 0) {
+            pivot -= A.lower[i] * A.eliminated[i - 1];
+        }
+        A.inversePivot[i] = 1.0 / pivot;
+        A.eliminated[i] = A.upper[i] * A.inversePivot[i];
+    }
+    return A;
+}
+
+// Thomas substitution with the elimination of A, in place on x.
+void substitute(const StepMatrix &A, double *x, std::size_t size) {
+    x[0] *= A.inversePivot[0];
+    for (std::size_t i = 1; i < size; ++i) {
+        x[i] = (x[i] - A.lower[i] * x[i - 1]) * A.inversePivot[i];
+    }
+    for (std::size_t i = size - 1; i-- > 0;) {
+        x[i] -= A.eliminated[i] * x[i + 1];
+    }
+}
+
+double relativeChange(double next, double previous) {
+    return std::fabs(next - previous) / std::max(1.0, std::fabs(next));
+}
+
+class Solver {
+  public:
+    Solver(const Operator &L, const std::vector<Price> &exercise,
+           bool american, const FiniteDifferenceSettings &settings)
+        : m_operator(L), m_exercise(exercise), m_american(american),
+          m_settings(settings), m_rhs(exercise.size()),
+          m_diagonal(exercise.size()), m_next(exercise.size()),
+          m_scratch(exercise.size()) {}
+
+    // Advances values by one step of the given system.
+    void step(const StepMatrix &A, std::vector<Price> &values) {
+        const std::size_t n = values.size();
+        const Operator &L = m_operator;
+        const double w = A.explicitWeight;
+        const Price *v = values.data();
+        m_rhs[0] = v[0] + w * (L.diagonal[0] * v[0] + L.upper[0] * v[1]);
+        for (std::size_t i = 1; i + 1 < n; ++i) {
+            m_rhs[i] = v[i] + w * (L.lower[i] * v[i - 1] +
+                                   L.diagonal[i] * v[i] +
+                                   L.upper[i] * v[i + 1]);
+        }
+        m_rhs[n - 1] = v[n - 1] + w * (L.lower[n - 1] * v[n - 2] +
+                                       L.diagonal[n - 1] * v[n - 1]);
+        if (!m_american) {
+            values.swap(m_rhs);
+            substitute(A, values.data(), n);
+        } else if (m_settings.exercise == FiniteDifferenceExercise::Penalty) {
+            penalty(A, values);
+        } else {
+            projectedSor(A, values);
+        }
+    }
+
+  private:
+    // Adds a large penalty on the diagonal wherever the iterate falls below
+    // exercise, until the set of penalised nodes stops changing.
+    void penalty(const StepMatrix &A, std::vector<Price> &values) {
+        const std::size_t n = values.size();
+        const double large = 1.0 / m_settings.tolerance;
+        for (int iteration = 0; iteration < maxPenaltyIterations;
+             ++iteration) {
+            for (std::size_t i = 0; i < n; ++i) {
+                bool active = values[i] < m_exercise[i];
+                m_diagonal[i] = A.diagonal[i] + (active ? large : 0.0);
+                m_next[i] = m_rhs[i] + (active ? large * m_exercise[i] : 0.0);
+            }
+            thomas(A.lower.data(), m_diagonal.data(), A.upper.data(),
+                   m_next.data(), m_next.data(), m_scratch.data(), n);
+            bool settled = true;
+            double change = 0.0;
+            for (std::size_t i = 0; i < n; ++i) {
+                settled = settled && (values[i] < m_exercise[i]) ==
+                                         (m_next[i] < m_exercise[i]);
+                change = std::max(change, relativeChange(m_next[i], values[i]));
+            }
+            values.swap(m_next);
+            if (settled || change < m_settings.tolerance) {
+                return;
+            }
+        }
+        throw std::runtime_error("Penalty iteration did not converge.");
+    }
+
+    void projectedSor(const StepMatrix &A, std::vector<Price> &values) {
+        const std::size_t n = values.size();
+        const double omega = m_settings.relaxation;
+        for (std::size_t i = 0; i < n; ++i) {
+            values[i] = std::max(values[i], m_exercise[i]);
+        }
+        for (int iteration = 0; iteration < maxSorIterations; ++iteration) {
+            double change = 0.0;
+            for (std::size_t i = 0; i < n; ++i) {
+                double sum = m_rhs[i];
+                if (i > 0) {
+                    sum -= A.lower[i] * values[i - 1];
+                }
+                if (i + 1 < n) {
+                    sum -= A.upper[i] * values[i + 1];
+                }
+                double next =
+                    values[i] + omega * (sum / A.diagonal[i] - values[i]);
+                next = std::max(next, m_exercise[i]);
+                change = std::max(change, relativeChange(next, values[i]));
+                values[i] = next;
+            }
+            if (change < m_settings.tolerance) {
+                return;
+            }
+        }
+        throw std::runtime_error("Projected SOR did not converge.");
+    }
+
+    const Operator &m_operator;
+    const std::vector<Price> &m_exercise;
+    bool m_american;
+    const FiniteDifferenceSettings &m_settings;
+    std::vector<double> m_rhs;
+    std::vector<double> m_diagonal;
+    std::vector<double> m_next;
+    std::vector<double> m_scratch;
+};
+} // namespace
+
+const char *toString(FiniteDifferenceExercise exercise) {
+    switch (exercise) {
+    case FiniteDifferenceExercise::Penalty:
+        return "penalty";
+    case FiniteDifferenceExercise::ProjectedSor:
+        return "psor";
+    default:
+        return "unknown";
+    }
+}
+
+Valuation FiniteDifferenceGrid::valuationAt(Price spot) const {
+    if (!contains(spot)) {
+        throw std::out_of_range(
+            "Spot lies outside the finite difference grid.");
+    }
+    std::size_t j =
+        std::upper_bound(spots.begin(), spots.end(), spot) - spots.begin();
+    j = std::clamp<std::size_t>(j, 1, spots.size() - 1) - 1;
+    const double h = spots[j + 1] - spots[j];
+    const double t = (spot - spots[j]) / h;
+    const double t2 = t * t, t3 = t2 * t;
+    Valuation valuation;
+    valuation.price = (2 * t3 - 3 * t2 + 1) * values[j] +
+                      (t3 - 2 * t2 + t) * h * deltas[j] +
+                      (-2 * t3 + 3 * t2) * values[j + 1] +
+                      (t3 - t2) * h * deltas[j + 1];
+    valuation.delta = (6 * t2 - 6 * t) / h * values[j] +
+                      (3 * t2 - 4 * t + 1) * deltas[j] +
+                      (-6 * t2 + 6 * t) / h * values[j + 1] +
+                      (3 * t2 - 2 * t) * deltas[j + 1];
+    valuation.gamma = (1 - t) * gammas[j] + t * gammas[j + 1];
+    valuation.theta = (1 - t) * thetas[j] + t * thetas[j + 1];
+    return valuation;
+}
+
+FiniteDifferenceGrid
+finiteDifferenceGrid(const options::ContractSpec &spec,
+                     const FiniteDifferenceSettings &settings,
+                     const std::optional<options::Payoff> &payoff) {
+    checkInputs(spec, settings);
+    FiniteDifferenceGrid grid;
+    grid.spots = spotGrid(spec, settings);
+    const std::vector<Price> &spots = grid.spots;
+    const std::size_t n = spots.size() - 1;
+    std::vector<Price> exercise(n + 1);
+    std::visit(
+        [&](const auto &f) {
+            for (std::size_t i = 0; i <= n; ++i) {
+                exercise[i] = f(spots[i]);
+            }
+        },
+        payoff ? *payoff
+               : options::makeVanillaPayoff(spec.type, spec.strikePrice));
+
+    const Operator L = buildOperator(spec, spots);
+    const int steps = settings.timeSteps;
+    const double dt = spec.maturity / steps;
+    const StepMatrix implicitHalf = stepMatrix(L, 1.0, 0.5 * dt);
+    const StepMatrix crankNicolson = stepMatrix(L, 0.5, dt);
+    Solver solver(L, exercise,
+                  spec.style == options::ExerciseStyle::American, settings);
+    std::vector<Price> values = exercise;
+    std::vector<Price> previous;
+    for (int step = 0; step < steps; ++step) {
+        if (step == steps - 1) {
+            previous = values;
+        }
+        if (step < settings.rannacherSteps) {
+            solver.step(implicitHalf, values);
+            solver.step(implicitHalf, values);
+        } else {
+            solver.step(crankNicolson, values);
+        }
+    }
+
+    grid.deltas.resize(n + 1);
+    grid.gammas.resize(n + 1);
+    grid.thetas.resize(n + 1);
+    for (std::size_t i = 1; i < n; ++i) {
+        double down = spots[i] - spots[i - 1];
+        double up = spots[i + 1] - spots[i];
+        grid.deltas[i] = (-up / (down * (down + up))) * values[i - 1] +
+                         (up - down) / (down * up) * values[i] +
+                         down / (up * (down + up)) * values[i + 1];
+        grid.gammas[i] = 2.0 *
+                         (down * values[i + 1] - (down + up) * values[i] +
+                          up * values[i - 1]) /
+                         (down * up * (down + up));
+    }
+    grid.deltas[0] = (values[1] - values[0]) / (spots[1] - spots[0]);
+    grid.deltas[n] = (values[n] - values[n - 1]) / (spots[n] - spots[n - 1]);
+    grid.gammas[0] = grid.gammas[1];
+    grid.gammas[n] = grid.gammas[n - 1];
+    for (std::size_t i = 0; i <= n; ++i) {
+        grid.thetas[i] = (previous[i] - values[i]) / dt;
+    }
+    grid.values = std::move(values);
+    return grid;
+}
+
+Price finiteDifferencePrice(const options::ContractSpec &spec,
+                            const FiniteDifferenceSettings &settings,
+                            const std::optional<options::Payoff> &payoff) {
+    return finiteDifferenceGrid(spec, settings, payoff)
+        .valuationAt(spec.spotPrice)
+        .price;
+}
+
+Valuation
+finiteDifferenceValuation(const options::ContractSpec &spec,
+                          const FiniteDifferenceSettings &settings,
+                          const std::optional<options::Payoff> &payoff) {
+    return finiteDifferenceGrid(spec, settings, payoff)
+        .valuationAt(spec.spotPrice);
+}
+} // namespace model
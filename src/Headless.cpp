@@ -0,0 +1,718 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <options-pricing-engine/Batch.hpp>
+#include <options-pricing-engine/BookFile.hpp>
+#include <options-pricing-engine/Headless.hpp>
+#include <options-pricing-engine/Model.hpp>
+#include <options-pricing-engine/Option.hpp>
+#include <options-pricing-engine/Random.hpp>
+#include <options-pricing-engine/ThreadPool.hpp>
+#include <options-pricing-engine/Types.hpp>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <toml++/toml.hpp>
+#include <vector>
+
+namespace cli {
+namespace {
+// Hand-off between two pipeline stages. close() ends the stream from either
+// side: pop drains what is left and then returns false, and push returns
+// false so a producer stops once its consumer has gone.
+template <typename T> class BoundedQueue {
+  public:
+    explicit BoundedQueue(std::size_t capacity) : m_capacity(capacity) {}
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock,
+                       [&] { return m_items.size() < m_capacity || m_closed; });
+        if (m_closed) {
+            return false;
+        }
+        m_items.push(std::move(item));
+        m_notEmpty.notify_one();
+        return true;
+    }
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [&] { return !m_items.empty() || m_closed; });
+        if (m_items.empty()) {
+            return false;
+        }
+        item = std::move(m_items.front());
+        m_items.pop();
+        m_notFull.notify_one();
+        return true;
+    }
+    void close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+  private:
+    std::size_t m_capacity;
+    std::queue<T> m_items;
+    std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+    bool m_closed{false};
+};
+
+constexpr std::size_t maxColumns = 9;
+
+struct PortfolioRow {
+    // 1-based position among the data rows of the input.
+    std::size_t index{0};
+    // Set once the row has been parsed and validated.
+    std::optional<options::ContractSpec> contract;
+    std::array<double, maxColumns> values{};
+    std::string error;
+};
+using RowChunk = std::vector<PortfolioRow>;
+
+std::string lowercase(std::string_view text) {
+    std::string result(text);
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return result;
+}
+
+bool endsWith(std::string_view text, std::string_view suffix) {
+    return text.size() >= suffix.size() &&
+           lowercase(text.substr(text.size() - suffix.size())) == suffix;
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() &&
+           std::isspace(static_cast<unsigned char>(text.front()))) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() &&
+           std::isspace(static_cast<unsigned char>(text.back()))) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+double parseNumber(std::string_view text, const char *name) {
+    double value = 0.0;
+    auto [ptr, ec] =
+        std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || ptr != text.data() + text.size()) {
+        throw std::invalid_argument(std::string("Invalid ") + name + " '" +
+                                    std::string(text) + "'.");
+    }
+    return value;
+}
+
+options::OptionType parseType(std::string_view text) {
+    std::string value = lowercase(text);
+    if (value == "call" || value == "0") {
+        return options::OptionType::Call;
+    }
+    if (value == "put" || value == "1") {
+        return options::OptionType::Put;
+    }
+    throw std::invalid_argument("Invalid option type '" + value + "'.");
+}
+
+options::ExerciseStyle parseStyle(std::string_view text) {
+    std::string value = lowercase(text);
+    if (value == "european" || value == "0") {
+        return options::ExerciseStyle::European;
+    }
+    if (value == "american" || value == "1") {
+        return options::ExerciseStyle::American;
+    }
+    throw std::invalid_argument("Invalid exercise style '" + value + "'.");
+}
+
+class RowSource {
+  public:
+    virtual ~RowSource() = default;
+    // Fills row with the next data row and returns false at the end of the
+    // input. Problems with the row itself go to row.error.
+    virtual bool next(PortfolioRow &row) = 0;
+};
+
+class CsvSource : public RowSource {
+  public:
+    explicit CsvSource(std::istream &in) : m_in(in) {
+        m_column.fill(missing);
+        std::string_view header;
+        while (header.empty() && std::getline(m_in, m_line)) {
+            header = trim(m_line);
+        }
+        std::size_t position = 0;
+        for (std::string_view name : split(header)) {
+            std::string key = lowercase(name);
+            for (std::size_t field = 0; field < fieldNames.size(); ++field) {
+                if (key == fieldNames[field]) {
+                    m_column[field] = position;
+                }
+            }
+            ++position;
+        }
+        for (std::size_t field = 0; field < requiredFields; ++field) {
+            if (m_column[field] == missing) {
+                throw std::invalid_argument(
+                    std::string("Portfolio header is missing the '") +
+                    fieldNames[field] + "' column.");
+            }
+        }
+    }
+
+    bool next(PortfolioRow &row) override {
+        std::string_view line;
+        while (line.empty()) {
+            if (!std::getline(m_in, m_line)) {
+                return false;
+            }
+            line = trim(m_line);
+        }
+        row = PortfolioRow{};
+        row.index = ++m_rows;
+        const std::vector<std::string_view> &cells = split(line);
+        auto cell = [&](std::size_t field) -> std::string_view {
+            std::size_t position = m_column[field];
+            return position < cells.size() ? cells[position]
+                                           : std::string_view();
+        };
+        auto optionalCell = [&](std::size_t field) {
+            return m_column[field] == missing ? std::string_view()
+                                              : cell(field);
+        };
+        try {
+            std::string_view yield = optionalCell(Yield);
+            std::string_view type = optionalCell(Type);
+            std::string_view style = optionalCell(Style);
+            row.contract =
+                options::Option(
+                    parseNumber(cell(Spot), "spot"),
+                    parseNumber(cell(Strike), "strike"),
+                    parseNumber(cell(Interest), "interest"), cell(Maturity),
+                    parseNumber(cell(Volatility), "volatility"),
+                    type.empty() ? options::OptionType::Call
+                                 : parseType(type),
+                    style.empty() ? options::ExerciseStyle::European
+                                  : parseStyle(style),
+                    yield.empty() ? 0.0 : parseNumber(yield, "yield"))
+                    .getSpec();
+        } catch (const std::exception &e) {
+            row.error = e.what();
+        }
+        return true;
+    }
+
+  private:
+    enum Field : std::size_t {
+        Spot,
+        Strike,
+        Interest,
+        Volatility,
+        Maturity,
+        Yield,
+        Type,
+        Style
+    };
+    static constexpr std::size_t requiredFields = Yield;
+    static constexpr std::size_t missing = static_cast<std::size_t>(-1);
+    static constexpr std::array<const char *, 8> fieldNames = {
+        "spot",     "strike", "interest", "volatility",
+        "maturity", "yield",  "type",     "style"};
+
+    const std::vector<std::string_view> &split(std::string_view line) {
+        m_cells.clear();
+        while (true) {
+            std::size_t comma = line.find(',');
+            m_cells.push_back(trim(line.substr(0, comma)));
+            if (comma == std::string_view::npos) {
+                return m_cells;
+            }
+            line.remove_prefix(comma + 1);
+        }
+    }
+
+    std::istream &m_in;
+    std::string m_line;
+    std::vector<std::string_view> m_cells;
+    std::array<std::size_t, fieldNames.size()> m_column;
+    std::size_t m_rows{0};
+};
+
+// Reads an [[option]] array of tables, or the single [option] table of
+// option.toml, with the same keys and defaults as CLI::loadOption.
+class TomlSource : public RowSource {
+  public:
+    explicit TomlSource(const std::string &path)
+        : m_config(toml::parse_file(path)) {
+        m_options = m_config["option"].as_array();
+        m_single = m_config["option"].as_table();
+        if (!m_options && !m_single) {
+            throw std::invalid_argument(
+                "Portfolio file has no [[option]] tables.");
+        }
+    }
+
+    bool next(PortfolioRow &row) override {
+        const toml::table *table = m_single;
+        if (m_options) {
+            if (m_rows == m_options->size()) {
+                return false;
+            }
+            table = (*m_options)[m_rows].as_table();
+        } else if (m_rows == 1) {
+            return false;
+        }
+        row = PortfolioRow{};
+        row.index = ++m_rows;
+        if (!table) {
+            row.error = "Option entry is not a table.";
+            return true;
+        }
+        const toml::table &option = *table;
+        try {
+            std::uint8_t type = option["type"].value_or(0);
+            std::uint8_t style = option["style"].value_or(0);
+            row.contract =
+                options::Option(
+                    option["spot"].value_or(-1.0),
+                    option["strike"].value_or(-1.0),
+                    option["interest"].value_or(-1.0),
+                    option["maturity"].value_or(std::string_view("")),
+                    option["volatility"].value_or(-1.0),
+                    static_cast<options::OptionType>(type),
+                    static_cast<options::ExerciseStyle>(style),
+                    option["yield"].value_or(0.0))
+                    .getSpec();
+        } catch (const std::exception &e) {
+            row.error = e.what();
+        }
+        return true;
+    }
+
+  private:
+    toml::table m_config;
+    toml::array *m_options{nullptr};
+    const toml::table *m_single{nullptr};
+    std::size_t m_rows{0};
+};
+
+// Rows of a memory mapped binary book. Only the rows of the chunk being
+// read are paged in.
+class BookSource : public RowSource {
+  public:
+    explicit BookSource(const std::string &path) : m_book(path) {}
+
+    bool next(PortfolioRow &row) override {
+        if (m_rows == m_book.size()) {
+            return false;
+        }
+        const batch::OptionBookView &book = m_book.view();
+        std::size_t i = m_rows;
+        row = PortfolioRow{};
+        row.index = ++m_rows;
+        try {
+            row.contract =
+                options::Option(book.spot[i], book.strike[i],
+                                book.interestRate[i], book.maturity[i],
+                                book.volatility[i], book.type[i],
+                                book.style[i], book.yield[i])
+                    .getSpec();
+        } catch (const std::exception &e) {
+            row.error = e.what();
+        }
+        return true;
+    }
+
+  private:
+    batch::MappedOptionBook m_book;
+    std::size_t m_rows{0};
+};
+
+std::vector<const char *> columnNames(HeadlessModel model) {
+    switch (model) {
+    case HeadlessModel::BlackScholes:
+        return {"price", "delta", "gamma", "theta", "vega",
+                "rho",   "vanna", "volga", "charm"};
+    case HeadlessModel::Binomial:
+    case HeadlessModel::FiniteDifference:
+        return {"price", "delta", "gamma", "theta"};
+    case HeadlessModel::MonteCarlo:
+        return {"price", "standard_error", "delta", "gamma",
+                "theta", "vega",           "rho"};
+    case HeadlessModel::American:
+        return {"price", "delta", "gamma", "theta", "vega", "rho"};
+    default:
+        throw std::invalid_argument("Unknown model.");
+    }
+}
+
+void priceRow(const HeadlessSettings &settings, std::uint64_t seed,
+              PortfolioRow &row) {
+    if (!row.contract) {
+        return;
+    }
+    const options::ContractSpec &spec = *row.contract;
+    try {
+        switch (settings.model) {
+        case HeadlessModel::BlackScholes: {
+            model::Valuation v = model::blackScholesValuation(spec);
+            row.values = {v.price, v.delta, v.gamma, v.theta, v.vega,
+                          v.rho,   v.vanna, v.volga, v.charm};
+            break;
+        }
+        case HeadlessModel::Binomial: {
+            thread_local model::LatticeWorkspace workspace;
+            model::Valuation v =
+                model::binomialValuation(spec, settings.steps, workspace);
+            row.values = {v.price, v.delta, v.gamma, v.theta};
+            break;
+        }
+        case HeadlessModel::MonteCarlo: {
+            model::MonteCarloSettings monteCarlo;
+            monteCarlo.paths = settings.paths;
+            monteCarlo.seed = seed;
+            monteCarlo.threads = settings.threads;
+            // Longstaff-Schwartz supports no variance reduction.
+            if (spec.style == options::ExerciseStyle::European) {
+                monteCarlo.varianceReduction = settings.varianceReduction;
+            }
+            monteCarlo.exerciseDates = settings.exerciseDates;
+            // American rows leave gamma and theta NaN.
+            model::MonteCarloEstimate estimate;
+            model::Valuation v = model::monteCarloValuation(
+                spec, monteCarlo, std::nullopt, &estimate);
+            row.values = {estimate.price, estimate.standardError,
+                          v.delta,        v.gamma,
+                          v.theta,        v.vega,
+                          v.rho};
+            break;
+        }
+        case HeadlessModel::American: {
+            model::AmericanSettings american;
+            american.fallbackSteps = settings.steps;
+            model::Valuation v = model::americanValuation(spec, american);
+            row.values = {v.price, v.delta, v.gamma, v.theta, v.vega, v.rho};
+            break;
+        }
+        case HeadlessModel::FiniteDifference: {
+            model::FiniteDifferenceSettings finiteDifference;
+            finiteDifference.timeSteps = settings.steps;
+            model::Valuation v =
+                model::finiteDifferenceValuation(spec, finiteDifference);
+            row.values = {v.price, v.delta, v.gamma, v.theta};
+            break;
+        }
+        default:
+            throw std::invalid_argument("Unknown model.");
+        }
+    } catch (const std::exception &e) {
+        row.error = e.what();
+    }
+}
+
+// Closed form and lattice rows are handed to the pool in groups so that
+// cheap rows do not pay for one task each. A Monte Carlo row is already
+// spread over the pool by the model, so those rows run one after another.
+void priceChunk(const HeadlessSettings &settings, std::uint64_t seed,
+                RowChunk &chunk) {
+    if (settings.model == HeadlessModel::MonteCarlo) {
+        for (PortfolioRow &row : chunk) {
+            priceRow(settings, seed, row);
+        }
+        return;
+    }
+    constexpr std::size_t grain = 64;
+    parallel::ThreadPool::shared().parallelFor(
+        (chunk.size() + grain - 1) / grain,
+        [&](std::size_t task) {
+            std::size_t end = std::min(chunk.size(), (task + 1) * grain);
+            for (std::size_t i = task * grain; i < end; ++i) {
+                priceRow(settings, seed, chunk[i]);
+            }
+        },
+        settings.threads);
+}
+
+// Values a row does not report are NaN and written as empty fields.
+void appendNumber(std::string &buffer, double value) {
+    if (std::isnan(value)) {
+        return;
+    }
+    char digits[32];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, end);
+}
+
+// Quotes an error message for CSV when it contains a delimiter or a quote.
+void appendText(std::string &buffer, std::string_view text) {
+    if (text.find_first_of(",\"\n") == std::string_view::npos) {
+        buffer.append(text);
+        return;
+    }
+    buffer.push_back('"');
+    for (char c : text) {
+        if (c == '"') {
+            buffer.push_back('"');
+        }
+        buffer.push_back(c == '\n' ? ' ' : c);
+    }
+    buffer.push_back('"');
+}
+
+void formatChunk(const RowChunk &chunk, std::size_t columns,
+                 std::string &buffer) {
+    buffer.clear();
+    for (const PortfolioRow &row : chunk) {
+        char digits[24];
+        auto [end, ec] =
+            std::to_chars(digits, digits + sizeof(digits), row.index);
+        buffer.append(digits, end);
+        for (std::size_t column = 0; column < columns; ++column) {
+            buffer.push_back(',');
+            if (row.error.empty()) {
+                appendNumber(buffer, row.values[column]);
+            }
+        }
+        buffer.push_back(',');
+        appendText(buffer, row.error);
+        buffer.push_back('\n');
+    }
+}
+
+
+template <typename T>
+T parseInteger(std::string_view option, std::string_view value) {
+    T result{};
+    auto [ptr, ec] =
+        std::from_chars(value.data(), value.data() + value.size(), result);
+    if (ec != std::errc() || ptr != value.data() + value.size()) {
+        throw std::invalid_argument("Invalid value '" + std::string(value) +
+                                    "' for " + std::string(option) + ".");
+    }
+    return result;
+}
+} // namespace
+
+HeadlessSettings parseArguments(int argc, const char *const *argv) {
+    HeadlessSettings settings;
+    for (int i = 0; i < argc; ++i) {
+        std::string_view option = argv[i];
+        if (i + 1 == argc) {
+            throw std::invalid_argument("Missing value for " +
+                                        std::string(option) + ".");
+        }
+        std::string_view value = argv[++i];
+        if (option == "--input") {
+            settings.input = value;
+        } else if (option == "--output") {
+            settings.output = value;
+        } else if (option == "--write-book") {
+            settings.writeBook = value;
+        } else if (option == "--model") {
+            std::string name = lowercase(value);
+            if (name == "blackscholes") {
+                settings.model = HeadlessModel::BlackScholes;
+            } else if (name == "binomial") {
+                settings.model = HeadlessModel::Binomial;
+            } else if (name == "montecarlo") {
+                settings.model = HeadlessModel::MonteCarlo;
+            } else if (name == "american") {
+                settings.model = HeadlessModel::American;
+            } else if (name == "pde") {
+                settings.model = HeadlessModel::FiniteDifference;
+            } else {
+                throw std::invalid_argument("Unknown model '" + name + "'.");
+            }
+        } else if (option == "--steps") {
+            settings.steps = parseInteger<int>(option, value);
+        } else if (option == "--paths") {
+            settings.paths = parseInteger<int>(option, value);
+        } else if (option == "--exercise-dates") {
+            settings.exerciseDates = parseInteger<int>(option, value);
+        } else if (option == "--seed") {
+            settings.seed = parseInteger<std::uint64_t>(option, value);
+        } else if (option == "--variance-reduction") {
+            std::string name = lowercase(value);
+            if (name == "none") {
+                settings.varianceReduction = model::VarianceReduction::None;
+            } else if (name == "antithetic") {
+                settings.varianceReduction =
+                    model::VarianceReduction::Antithetic;
+            } else if (name == "control") {
+                settings.varianceReduction =
+                    model::VarianceReduction::ControlVariate;
+            } else if (name == "sobol") {
+                settings.varianceReduction =
+                    model::VarianceReduction::QuasiRandom;
+            } else {
+                throw std::invalid_argument(
+                    "Unknown variance reduction '" + name + "'.");
+            }
+        } else if (option == "--threads") {
+            settings.threads = parseInteger<unsigned>(option, value);
+        } else if (option == "--chunk-size") {
+            settings.chunkSize = parseInteger<std::size_t>(option, value);
+        } else {
+            throw std::invalid_argument("Unknown option " +
+                                        std::string(option) + ".");
+        }
+    }
+    if (settings.input.empty()) {
+        throw std::invalid_argument("An --input file is required.");
+    }
+    if (settings.steps < 2 || settings.paths <= 0 ||
+        settings.exerciseDates <= 0 || settings.chunkSize == 0) {
+        throw std::invalid_argument("Steps must be at least 2, and paths, "
+                                    "exercise dates and chunk size must be "
+                                    "positive.");
+    }
+    return settings;
+}
+
+// Loads every valid row into a book and writes it out. Rows that fail to
+// parse are skipped and reported on standard error.
+void convertToBook(RowSource &source, const std::string &path) {
+    batch::OptionBook book;
+    PortfolioRow row;
+    std::size_t skipped = 0;
+    while (source.next(row)) {
+        if (row.contract) {
+            const options::ContractSpec &spec = *row.contract;
+            book.add(spec.spotPrice, spec.strikePrice, spec.interestRate,
+                     spec.maturity, spec.volatility, spec.type, spec.style,
+                     spec.yield);
+            continue;
+        }
+        ++skipped;
+        std::cerr << "Row " << row.index << " skipped: " << row.error << "\n";
+    }
+    batch::writeBookFile(path, book.view());
+    std::cerr << "Wrote " << book.size() << " rows to " << path;
+    if (skipped > 0) {
+        std::cerr << ", skipped " << skipped;
+    }
+    std::cerr << ".\n";
+}
+
+void runHeadless(const HeadlessSettings &settings) {
+    std::ios::sync_with_stdio(false);
+    std::vector<char> inputBuffer(1 << 20);
+    std::ifstream inputFile;
+    std::unique_ptr<RowSource> source;
+    if (settings.input == "-") {
+        source = std::make_unique<CsvSource>(std::cin);
+    } else if (endsWith(settings.input, ".toml")) {
+        source = std::make_unique<TomlSource>(settings.input);
+    } else if (endsWith(settings.input, ".book")) {
+        source = std::make_unique<BookSource>(settings.input);
+    } else {
+        inputFile.rdbuf()->pubsetbuf(inputBuffer.data(), inputBuffer.size());
+        inputFile.open(settings.input, std::ios::binary);
+        if (!inputFile) {
+            throw std::runtime_error("Cannot open input file " +
+                                     settings.input + ".");
+        }
+        source = std::make_unique<CsvSource>(inputFile);
+    }
+    if (!settings.writeBook.empty()) {
+        convertToBook(*source, settings.writeBook);
+        return;
+    }
+    std::ofstream outputFile;
+    std::ostream *output = &std::cout;
+    if (settings.output != "-") {
+        outputFile.open(settings.output, std::ios::binary);
+        if (!outputFile) {
+            throw std::runtime_error("Cannot open output file " +
+                                     settings.output + ".");
+        }
+        output = &outputFile;
+    }
+    const std::vector<const char *> columns = columnNames(settings.model);
+    *output << "row";
+    for (const char *column : columns) {
+        *output << ',' << column;
+    }
+    *output << ",error\n";
+
+    const std::uint64_t seed =
+        settings.seed == 0 ? rng::randomSeed() : settings.seed;
+    BoundedQueue<RowChunk> parsed(2);
+    BoundedQueue<RowChunk> priced(2);
+    std::exception_ptr readError, priceError, writeError;
+    std::thread reader([&] {
+        try {
+            while (true) {
+                RowChunk chunk;
+                chunk.reserve(settings.chunkSize);
+                PortfolioRow row;
+                while (chunk.size() < settings.chunkSize &&
+                       source->next(row)) {
+                    chunk.push_back(std::move(row));
+                }
+                if (chunk.empty() || !parsed.push(std::move(chunk))) {
+                    break;
+                }
+            }
+        } catch (...) {
+            readError = std::current_exception();
+        }
+        parsed.close();
+    });
+    std::thread writer([&] {
+        try {
+            RowChunk chunk;
+            std::string buffer;
+            while (priced.pop(chunk)) {
+                formatChunk(chunk, columns.size(), buffer);
+                output->write(buffer.data(), buffer.size());
+            }
+            output->flush();
+            if (!*output) {
+                throw std::runtime_error("Failed to write results.");
+            }
+        } catch (...) {
+            writeError = std::current_exception();
+            parsed.close();
+        }
+        priced.close();
+    });
+    try {
+        RowChunk chunk;
+        while (parsed.pop(chunk)) {
+            priceChunk(settings, seed, chunk);
+            if (!priced.push(std::move(chunk))) {
+                break;
+            }
+        }
+    } catch (...) {
+        priceError = std::current_exception();
+        parsed.close();
+    }
+    priced.close();
+    reader.join();
+    writer.join();
+    for (const std::exception_ptr &error : {readError, priceError,
+                                            writeError}) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+} // namespace cli
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <cmath>
+#include <options-pricing-engine/Model.hpp>
+#include <options-pricing-engine/Payoff.hpp>
+#include <options-pricing-engine/Utils.hpp>
+#include <stdexcept>
+#include <variant>
+
+namespace model {
+namespace {
+// Boyle's trinomial tree: node spots are S * u^k for k in [-steps, steps].
+struct Trinomial {
+    int steps;
+    double uptick;
+    double up;
+    double middle;
+    double down;
+    double discount;
+};
+
+Lattice leisenReimerLattice(const options::ContractSpec &spec, int steps) {
+    const double n = steps;
+    const double T = spec.maturity;
+    const double dt = T / steps;
+    double d1 = utils::d1(spec.spotPrice, spec.strikePrice, spec.interestRate,
+                          spec.volatility, T, spec.yield);
+    double d2 = d1 - spec.volatility * std::sqrt(T);
+    // Peizer-Pratt method 2 inversion of the normal CDF.
+    auto inversion = [n](double z) {
+        double x = z / (n + 1.0 / 3.0 + 0.1 / (n + 1.0));
+        return 0.5 + std::copysign(
+                         0.5 * std::sqrt(1.0 - std::exp(-x * x *
+                                                         (n + 1.0 / 6.0))),
+                         z);
+    };
+    double growth = std::exp((spec.interestRate - spec.yield) * dt);
+    Lattice lattice;
+    lattice.steps = steps;
+    lattice.probability = inversion(d2);
+    lattice.uptick = growth * inversion(d1) / lattice.probability;
+    lattice.downtick = (growth - lattice.probability * lattice.uptick) /
+                       (1.0 - lattice.probability);
+    lattice.discount = std::exp(-spec.interestRate * dt);
+    return lattice;
+}
+
+Trinomial trinomialLattice(const options::ContractSpec &spec, int steps) {
+    const double dt = spec.maturity / steps;
+    const double sigma = spec.volatility;
+    double drift = spec.interestRate - spec.yield - 0.5 * sigma * sigma;
+    double skew = drift * std::sqrt(dt / (12.0 * sigma * sigma));
+    Trinomial tree;
+    tree.steps = steps;
+    tree.uptick = std::exp(sigma * std::sqrt(3.0 * dt));
+    tree.up = 1.0 / 6.0 + skew;
+    tree.middle = 2.0 / 3.0;
+    tree.down = 1.0 / 6.0 - skew;
+    tree.discount = std::exp(-spec.interestRate * dt);
+    if (tree.up < 0.0 || tree.down < 0.0) {
+        throw std::invalid_argument(
+            "Too few trinomial steps for the drift of this contract.");
+    }
+    return tree;
+}
+
+// Black-Scholes prices over the final step, which replace the last step of
+// a smoothed tree.
+class FinalStep {
+  public:
+    FinalStep(const options::ContractSpec &spec, double dt) : m_spec(spec) {
+        m_spec.maturity = dt;
+        m_spec.style = options::ExerciseStyle::European;
+        m_terms = blackScholesTerms(m_spec);
+    }
+    Price operator()(Price spot) {
+        m_spec.spotPrice = spot;
+        return blackScholesPrice(m_spec, m_terms);
+    }
+
+  private:
+    options::ContractSpec m_spec;
+    ClosedFormTerms m_terms;
+};
+
+// Rollback of a recombining binomial tree with any up and down moves, so
+// node (step, j) sits at S * u^j * d^(step - j).
+template <options::ExerciseStyle Style, typename Payoff>
+Price rollbackBinomial(const options::ContractSpec &spec,
+                       const Lattice &lattice, const Payoff &payoff,
+                       bool smooth, LatticeWorkspace &workspace) {
+    const int steps = lattice.steps;
+    const Price S = spec.spotPrice;
+    workspace.exercise.resize(2 * (steps + 1));
+    double *up = workspace.exercise.data();
+    double *down = up + steps + 1;
+    up[0] = down[0] = 1.0;
+    for (int k = 1; k <= steps; ++k) {
+        up[k] = up[k - 1] * lattice.uptick;
+        down[k] = down[k - 1] * lattice.downtick;
+    }
+    auto spot = [&](int step, int j) { return S * up[j] * down[step - j]; };
+    constexpr bool american = Style == options::ExerciseStyle::American;
+
+    workspace.values.resize(steps + 1);
+    Price *values = workspace.values.data();
+    int last = steps;
+    if (smooth) {
+        last = steps - 1;
+        FinalStep finalStep(spec, spec.maturity / steps);
+        for (int j = 0; j <= last; ++j) {
+            Price node = spot(last, j);
+            values[j] = finalStep(node);
+            if constexpr (american) {
+                values[j] = std::max(values[j], payoff(node));
+            }
+        }
+    } else {
+        for (int j = 0; j <= steps; ++j) {
+            values[j] = payoff(spot(steps, j));
+        }
+    }
+    double upWeight = lattice.discount * lattice.probability;
+    double downWeight = lattice.discount * (1.0 - lattice.probability);
+    for (int step = last - 1; step >= 0; --step) {
+        for (int j = 0; j <= step; ++j) {
+            Price continuation =
+                upWeight * values[j + 1] + downWeight * values[j];
+            if constexpr (american) {
+                values[j] = std::max(continuation, payoff(spot(step, j)));
+            } else {
+                values[j] = continuation;
+            }
+        }
+    }
+    return values[0];
+}
+
+// Node (step, i) of the trinomial tree reads exercise[steps - step + i].
+template <options::ExerciseStyle Style, typename Payoff>
+Price rollbackTrinomial(const options::ContractSpec &spec,
+                        const Trinomial &tree, const Payoff &payoff,
+                        bool smooth, LatticeWorkspace &workspace) {
+    const int steps = tree.steps;
+    const Price S = spec.spotPrice;
+    const double logUptick = std::log(tree.uptick);
+    auto spot = [&](int k) { return S * std::exp((k - steps) * logUptick); };
+    workspace.exercise.resize(2 * steps + 1);
+    Price *exercise = workspace.exercise.data();
+    for (int k = 0; k <= 2 * steps; ++k) {
+        exercise[k] = payoff(spot(k));
+    }
+    constexpr bool american = Style == options::ExerciseStyle::American;
+
+    workspace.values.resize(2 * steps + 1);
+    Price *values = workspace.values.data();
+    int last = steps;
+    if (smooth) {
+        last = steps - 1;
+        FinalStep finalStep(spec, spec.maturity / steps);
+        for (int i = 0; i <= 2 * last; ++i) {
+            values[i] = finalStep(spot(i + 1));
+            if constexpr (american) {
+                values[i] = std::max(values[i], exercise[i + 1]);
+            }
+        }
+    } else {
+        std::copy(exercise, exercise + 2 * steps + 1, values);
+    }
+    double upWeight = tree.discount * tree.up;
+    double middleWeight = tree.discount * tree.middle;
+    double downWeight = tree.discount * tree.down;
+    for (int step = last - 1; step >= 0; --step) {
+        const Price *nodeExercise = exercise + (steps - step);
+        for (int i = 0; i <= 2 * step; ++i) {
+            Price continuation = upWeight * values[i + 2] +
+                                 middleWeight * values[i + 1] +
+                                 downWeight * values[i];
+            if constexpr (american) {
+                values[i] = std::max(continuation, nodeExercise[i]);
+            } else {
+                values[i] = continuation;
+            }
+        }
+    }
+    return values[0];
+}
+
+Price treePrice(const options::ContractSpec &spec, int steps,
+                LatticeScheme scheme, bool smooth,
+                const options::Payoff &payoff, LatticeWorkspace &workspace) {
+    return std::visit(
+        [&](const auto &payoff) {
+            return options::dispatch(spec.style, [&](auto style) {
+                switch (scheme) {
+                case LatticeScheme::LeisenReimer:
+                    return rollbackBinomial<style()>(
+                        spec, leisenReimerLattice(spec, steps), payoff,
+                        smooth, workspace);
+                case LatticeScheme::Trinomial:
+                    return rollbackTrinomial<style()>(
+                        spec, trinomialLattice(spec, steps), payoff, smooth,
+                        workspace);
+                default:
+                    return rollbackBinomial<style()>(
+                        spec, binomialLattice(spec, steps), payoff, smooth,
+                        workspace);
+                }
+            });
+        },
+        payoff);
+}
+} // namespace
+
+const char *toString(LatticeScheme scheme) {
+    switch (scheme) {
+    case LatticeScheme::CoxRossRubinstein:
+        return "crr";
+    case LatticeScheme::LeisenReimer:
+        return "leisen-reimer";
+    case LatticeScheme::Trinomial:
+        return "trinomial";
+    default:
+        return "unknown";
+    }
+}
+
+const char *toString(Extrapolation extrapolation) {
+    switch (extrapolation) {
+    case Extrapolation::None:
+        return "none";
+    case Extrapolation::Richardson:
+        return "richardson";
+    case Extrapolation::SmoothedRichardson:
+        return "bbsr";
+    default:
+        return "unknown";
+    }
+}
+
+Price latticePrice(options::ContractSpec spec, int steps,
+                   const LatticeSettings &settings,
+                   LatticeWorkspace &workspace,
+                   const std::optional<options::Payoff> &payoff) {
+    if (steps <= 0) {
+        throw std::invalid_argument(
+            "Number of steps must be a positive integer.");
+    }
+    const LatticeScheme scheme = settings.scheme;
+    const bool smooth =
+        settings.extrapolation == Extrapolation::SmoothedRichardson;
+    if (smooth && payoff) {
+        throw std::invalid_argument(
+            "Black-Scholes smoothing needs the vanilla payoff.");
+    }
+    if (smooth && scheme == LatticeScheme::LeisenReimer) {
+        throw std::invalid_argument(
+            "Black-Scholes smoothing does not apply to Leisen-Reimer trees.");
+    }
+    if (settings.extrapolation == Extrapolation::Richardson &&
+        scheme != LatticeScheme::LeisenReimer) {
+        throw std::invalid_argument(
+            "Richardson extrapolation needs Leisen-Reimer trees; use BBSR on "
+            "CRR and trinomial trees.");
+    }
+    auto price = [&](int n) {
+        if (scheme == LatticeScheme::CoxRossRubinstein && !smooth) {
+            return binomialPrice(spec, n, workspace, payoff);
+        }
+        options::Payoff resolved =
+            payoff ? *payoff
+                   : options::makeVanillaPayoff(spec.type, spec.strikePrice);
+        return treePrice(spec, n, scheme, smooth, resolved, workspace);
+    };
+    const bool odd = scheme == LatticeScheme::LeisenReimer;
+    const int fine = odd ? steps | 1 : steps;
+    Price finePrice = price(fine);
+    if (settings.extrapolation == Extrapolation::None) {
+        return finePrice;
+    }
+    if (steps < 2) {
+        throw std::invalid_argument(
+            "Extrapolation needs at least two steps.");
+    }
+    const int coarse = odd ? (fine / 2) | 1 : fine / 2;
+    Price coarsePrice = price(coarse);
+    // Leisen-Reimer errors fall as 1 / n^2 for European contracts, but the
+    // early exercise boundary leaves American ones at 1 / n. Smoothed CRR
+    // and trinomial errors fall as 1 / n.
+    double order =
+        odd && spec.style == options::ExerciseStyle::European ? 2.0 : 1.0;
+    double fineWeight = std::pow(fine, order);
+    double coarseWeight = std::pow(coarse, order);
+    return (fineWeight * finePrice - coarseWeight * coarsePrice) /
+           (fineWeight - coarseWeight);
+}
+} // namespace model
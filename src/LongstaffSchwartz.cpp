@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <options-pricing-engine/Model.hpp>
+#include <options-pricing-engine/Random.hpp>
+#include <options-pricing-engine/ThreadPool.hpp>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+namespace model {
+namespace {
+// Paths live in blocks of this many, and each task owns a fixed run of
+// blocks, as in the European estimator.
+constexpr std::size_t blockSize = 4096;
+constexpr std::size_t blocksPerTask = 4;
+constexpr int maxBasis = maxBasisDegree + 1;
+constexpr double z95 = 1.959963984540054;
+
+// Normal equations of the regression of continuation values on the powers
+// 1, x, ..., x^degree, upper triangle only.
+struct NormalEquations {
+    std::array<double, maxBasis * maxBasis> gram{};
+    std::array<double, maxBasis> moments{};
+    std::size_t count{0};
+    void merge(const NormalEquations &other) {
+        for (int k = 0; k < maxBasis * maxBasis; ++k) {
+            gram[k] += other.gram[k];
+        }
+        for (int k = 0; k < maxBasis; ++k) {
+            moments[k] += other.moments[k];
+        }
+        count += other.count;
+    }
+};
+
+// Solves the normal equations by Cholesky factorisation. Returns false
+// when the in the money paths are too few or too clustered to fix every
+// coefficient, in which case the date is not exercised.
+bool solve(const NormalEquations &equations, int n,
+           std::array<double, maxBasis> &coefficients) {
+    if (equations.count < static_cast<std::size_t>(2 * n)) {
+        return false;
+    }
+    std::array<double, maxBasis * maxBasis> factor{};
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i <= j; ++i) {
+            double sum = equations.gram[i * maxBasis + j];
+            for (int k = 0; k < i; ++k) {
+                sum -= factor[k * maxBasis + i] * factor[k * maxBasis + j];
+            }
+            if (i < j) {
+                factor[i * maxBasis + j] = sum / factor[i * maxBasis + i];
+            } else if (sum > 1e-12 * equations.gram[j * maxBasis + j]) {
+                factor[j * maxBasis + j] = std::sqrt(sum);
+            } else {
+                return false;
+            }
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        double sum = equations.moments[i];
+        for (int k = 0; k < i; ++k) {
+            sum -= factor[k * maxBasis + i] * coefficients[k];
+        }
+        coefficients[i] = sum / factor[i * maxBasis + i];
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        double sum = coefficients[i];
+        for (int k = i + 1; k < n; ++k) {
+            sum -= factor[i * maxBasis + k] * coefficients[k];
+        }
+        coefficients[i] = sum / factor[i * maxBasis + i];
+    }
+    return true;
+}
+
+// Exercise rule of one date: exercise where the payoff beats the fitted
+// continuation value. Without a fit the date is skipped.
+struct Rule {
+    bool active{false};
+    std::array<double, maxBasis> coefficients{};
+};
+// Rules by exercise date; date 0 is decided against the payoff directly.
+using Rules = std::vector<Rule>;
+
+// Brownian motion, spot and cash flow discounted to the current date.
+struct PathState {
+    std::vector<double> brownian;
+    std::vector<Price> spot;
+    std::vector<Price> cash;
+};
+
+// Prices by backward induction over the exercise dates without storing
+// paths. The Brownian motion is drawn at maturity and then walked back to
+// earlier dates by the Brownian bridge, whose normals are regenerated from
+// a Philox stream per block and date. Each sweep over the paths applies
+// the exercise rule fitted at the later date, steps back one date and
+// accumulates the regression of the earlier one, so a pricing makes one
+// pass over the path state per date. With fit set the rules are fitted and
+// stored in rules, otherwise the given ones are applied without regressing.
+template <typename Payoff>
+MonteCarloEstimate estimate(const options::ContractSpec &spec,
+                            const MonteCarloSettings &settings,
+                            const Payoff &payoff, Rules &rules, bool fit) {
+    const std::size_t paths = settings.paths;
+    const int dates = settings.exerciseDates;
+    const int basis = settings.basisDegree + 1;
+    const double T = spec.maturity;
+    const double dt = T / dates;
+    const double sigma = spec.volatility;
+    const double mu = spec.interestRate - spec.yield - 0.5 * sigma * sigma;
+    const double discount = std::exp(-spec.interestRate * dt);
+    const Price S0 = spec.spotPrice;
+    const double scale = 1.0 / spec.strikePrice;
+    const rng::Philox4x32 generator(settings.seed);
+    const std::size_t blocks = (paths + blockSize - 1) / blockSize;
+    const std::size_t tasks = (blocks + blocksPerTask - 1) / blocksPerTask;
+
+    PathState state;
+    state.brownian.resize(paths);
+    state.spot.resize(paths);
+    state.cash.resize(paths);
+    auto basisValue = [&](Price spot) { return spot * scale - 1.0; };
+    auto continuation = [&](const Rule &rule, double x) {
+        double value = rule.coefficients[basis - 1];
+        for (int k = basis - 2; k >= 0; --k) {
+            value = value * x + rule.coefficients[k];
+        }
+        return value;
+    };
+    // Visits every block in task order, handing body the block's first path,
+    // its size and a buffer of normals for date.
+    auto sweep = [&](int date, std::vector<NormalEquations> &equations,
+                     const auto &body) {
+        parallel::ThreadPool::shared().parallelFor(
+            tasks,
+            [&](std::size_t task) {
+                std::array<double, blockSize> normals;
+                std::size_t end = std::min(blocks, (task + 1) * blocksPerTask);
+                for (std::size_t block = task * blocksPerTask; block < end;
+                     ++block) {
+                    std::size_t first = block * blockSize;
+                    std::size_t count = std::min(blockSize, paths - first);
+                    if (date > 0) {
+                        rng::fillNormals(generator,
+                                         block * dates + (date - 1),
+                                         normals.data(), count);
+                    }
+                    body(equations[task], first, count, normals.data());
+                }
+            },
+            settings.threads);
+    };
+
+    // Accumulates the regression of the cash flows at date on the in the
+    // money spots there.
+    auto accumulate = [&](NormalEquations &equations, std::size_t i,
+                          Price spot) {
+        if (!(payoff(spot) > 0.0)) {
+            return;
+        }
+        std::array<double, 2 * maxBasis - 1> powers;
+        powers[0] = 1.0;
+        double x = basisValue(spot);
+        for (int k = 1; k < 2 * basis - 1; ++k) {
+            powers[k] = powers[k - 1] * x;
+        }
+        for (int a = 0; a < basis; ++a) {
+            for (int b = a; b < basis; ++b) {
+                equations.gram[a * maxBasis + b] += powers[a + b];
+            }
+            equations.moments[a] += powers[a] * state.cash[i];
+        }
+        ++equations.count;
+    };
+    auto spotAt = [&](int date, double brownian) {
+        return S0 * std::exp(mu * date * dt + sigma * brownian);
+    };
+
+    // Maturity: the Brownian motion is drawn whole and the cash flow is the
+    // payoff.
+    std::vector<NormalEquations> equations(tasks);
+    sweep(dates, equations,
+          [&](NormalEquations &, std::size_t first, std::size_t count,
+              const double *normals) {
+              double root = std::sqrt(T);
+              for (std::size_t i = first; i < first + count; ++i) {
+                  state.brownian[i] = root * normals[i - first];
+                  state.spot[i] = spotAt(dates, state.brownian[i]);
+                  state.cash[i] = payoff(state.spot[i]);
+              }
+          });
+    if (fit) {
+        rules.assign(dates, Rule{});
+    }
+    Rule rule;
+    for (int date = dates - 1; date >= 0; --date) {
+        // Bridge from date + 1 back to date: W_t = W_u t / u plus a normal
+        // of variance t (u - t) / u.
+        double shrink = static_cast<double>(date) / (date + 1);
+        double spread = std::sqrt(dt * shrink);
+        std::fill(equations.begin(), equations.end(), NormalEquations{});
+        sweep(date, equations,
+              [&](NormalEquations &accumulator, std::size_t first,
+                  std::size_t count, const double *normals) {
+                  for (std::size_t i = first; i < first + count; ++i) {
+                      if (rule.active) {
+                          Price exercise = payoff(state.spot[i]);
+                          if (exercise > 0.0 &&
+                              exercise > continuation(
+                                             rule, basisValue(state.spot[i]))) {
+                              state.cash[i] = exercise;
+                          }
+                      }
+                      state.cash[i] *= discount;
+                      if (date == 0) {
+                          continue;
+                      }
+                      state.brownian[i] = shrink * state.brownian[i] +
+                                          spread * normals[i - first];
+                      state.spot[i] = spotAt(date, state.brownian[i]);
+                      if (fit) {
+                          accumulate(accumulator, i, state.spot[i]);
+                      }
+                  }
+              });
+        if (date == 0) {
+            break;
+        }
+        if (fit) {
+            NormalEquations total;
+            for (const NormalEquations &accumulator : equations) {
+                total.merge(accumulator);
+            }
+            rule.active = solve(total, basis, rule.coefficients);
+            rules[date] = rule;
+        } else {
+            rule = rules[date];
+        }
+    }
+
+    utils::RunningStats stats;
+    for (std::size_t first = 0; first < paths; first += blockSize) {
+        stats.addBlock(state.cash.data() + first,
+                       std::min(blockSize, paths - first));
+    }
+    MonteCarloEstimate result;
+    result.paths = paths;
+    result.price = settings.exerciseToday ? std::max(stats.mean(), payoff(S0))
+                                          : stats.mean();
+    result.standardError = std::sqrt(stats.variance() / paths);
+    result.lowerBound = result.price - z95 * result.standardError;
+    result.upperBound = result.price + z95 * result.standardError;
+    return result;
+}
+
+void checkInputs(const options::ContractSpec &spec,
+                 const MonteCarloSettings &settings) {
+    if (settings.paths <= 0) {
+        throw std::invalid_argument(
+            "N.o of iterations must be a positive integer.");
+    }
+    if (settings.exerciseDates <= 0) {
+        throw std::invalid_argument(
+            "Number of exercise dates must be a positive integer.");
+    }
+    if (settings.basisDegree < 1 || settings.basisDegree > maxBasisDegree) {
+        throw std::invalid_argument(
+            "Regression basis degree must be between 1 and 4.");
+    }
+    if (settings.varianceReduction != VarianceReduction::None) {
+        throw std::invalid_argument(
+            "Longstaff-Schwartz supports no variance reduction.");
+    }
+    if (!(spec.spotPrice > 0.0) || !(spec.strikePrice > 0.0) ||
+        !(spec.maturity > 0.0) || !(spec.volatility > 0.0)) {
+        throw std::invalid_argument(
+            "Spot, strike, maturity and volatility must be positive.");
+    }
+}
+
+options::Payoff resolvePayoff(const options::ContractSpec &spec,
+                              const std::optional<options::Payoff> &payoff) {
+    return payoff ? *payoff
+                  : options::makeVanillaPayoff(spec.type, spec.strikePrice);
+}
+} // namespace
+
+MonteCarloEstimate
+longstaffSchwartzEstimate(const options::ContractSpec &spec,
+                          const MonteCarloSettings &settings,
+                          const std::optional<options::Payoff> &payoff) {
+    checkInputs(spec, settings);
+    return std::visit(
+        [&](const auto &concrete) {
+            Rules rules;
+            return estimate(spec, settings, concrete, rules, true);
+        },
+        resolvePayoff(spec, payoff));
+}
+
+std::vector<Price>
+longstaffSchwartzRevalue(const options::ContractSpec &spec,
+                         const std::vector<options::ContractSpec> &bumped,
+                         const MonteCarloSettings &settings,
+                         const std::optional<options::Payoff> &payoff,
+                         MonteCarloEstimate *estimate) {
+    checkInputs(spec, settings);
+    for (const options::ContractSpec &copy : bumped) {
+        checkInputs(copy, settings);
+    }
+    return std::visit(
+        [&](const auto &concrete) {
+            Rules rules;
+            MonteCarloEstimate fitted =
+                model::estimate(spec, settings, concrete, rules, true);
+            if (estimate) {
+                *estimate = fitted;
+            }
+            std::vector<Price> prices{fitted.price};
+            for (const options::ContractSpec &copy : bumped) {
+                prices.push_back(
+                    model::estimate(copy, settings, concrete, rules, false)
+                        .price);
+            }
+            return prices;
+        },
+        resolvePayoff(spec, payoff));
+}
+} // namespace model
@@ -0,0 +1,14 @@
+#include <options-pricing-engine/MathKernels.hpp>
+
+namespace math {
+const char *toString(Accuracy accuracy) {
+    switch (accuracy) {
+    case Accuracy::Exact:
+        return "exact";
+    case Accuracy::Fast:
+        return "fast";
+    default:
+        return "unknown";
+    }
+}
+} // namespace math
@@ -1,15 +1,371 @@
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <options-pricing-engine/Batch.hpp>
+#include <options-pricing-engine/MathKernels.hpp>
 #include <options-pricing-engine/Model.hpp>
 #include <options-pricing-engine/Option.hpp>
+#include <options-pricing-engine/PricingCache.hpp>
+#include <options-pricing-engine/Random.hpp>
+#include <options-pricing-engine/ThreadPool.hpp>
 #include <options-pricing-engine/Types.hpp>
 #include <options-pricing-engine/Utils.hpp>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <variant>
 #include <vector>
 
 namespace model {
+namespace {
+void requireEuropean(const options::ContractSpec &spec) {
+    if (spec.style == options::ExerciseStyle::American) {
+        throw std::invalid_argument("Option exercise style must be European");
+    }
+}
+
+// Model parameters a cache entry is keyed on besides the contract.
+struct CacheTag {
+    cache::ModelKind model;
+    int resolution;
+    std::uint64_t seed;
+    std::uint8_t variant;
+    cache::Parameters parameters{};
+};
+
+std::uint64_t bits(double value) {
+    std::uint64_t result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+CacheTag closedFormTag(math::Accuracy accuracy) {
+    return {cache::ModelKind::BlackScholes, 0, 0,
+            static_cast<std::uint8_t>(accuracy)};
+}
+CacheTag latticeTag(int steps, const LatticeSettings &settings) {
+    return {cache::ModelKind::Binomial, steps, 0,
+            static_cast<std::uint8_t>(
+                static_cast<int>(settings.scheme) * 4 +
+                static_cast<int>(settings.extrapolation))};
+}
+// Estimates do not depend on the thread count, so it is not part of the key.
+// The key's style keeps European entries apart from American ones.
+CacheTag monteCarloTag(const MonteCarloSettings &settings) {
+    return {cache::ModelKind::MonteCarlo,
+            settings.paths,
+            settings.seed,
+            static_cast<std::uint8_t>(settings.varianceReduction),
+            {static_cast<std::uint64_t>(settings.exerciseDates),
+             static_cast<std::uint64_t>(settings.basisDegree),
+             settings.exerciseToday}};
+}
+
+// The error budget decides between approximation and lattice, so its
+// tolerances are keyed on.
+CacheTag americanTag(const AmericanSettings &settings) {
+    return {cache::ModelKind::American,
+            settings.fallbackSteps,
+            0,
+            static_cast<std::uint8_t>(settings.method),
+            {bits(settings.absoluteTolerance),
+             bits(settings.relativeTolerance)}};
+}
+
+// The grid is keyed on its shape, with time steps as the resolution.
+CacheTag finiteDifferenceTag(const FiniteDifferenceSettings &settings) {
+    std::uint64_t nodes = static_cast<std::uint32_t>(settings.spotNodes);
+    return {cache::ModelKind::FiniteDifference,
+            settings.timeSteps,
+            0,
+            static_cast<std::uint8_t>(settings.exercise),
+            {nodes << 32 | static_cast<std::uint32_t>(settings.rannacherSteps),
+             bits(settings.width), bits(settings.concentration),
+             bits(settings.tolerance), bits(settings.relaxation)}};
+}
+
+// compute() through the cache when there is one. Scalars travel in the
+// price field of the cached valuation.
+template <typename F>
+auto cached(const std::shared_ptr<cache::PricingCache> &cache,
+            const options::ContractSpec &spec, const CacheTag &tag,
+            cache::Quantity quantity, F &&compute) {
+    if (!cache) {
+        return compute();
+    }
+    cache::Key key = cache->makeKey(spec, tag.model, quantity,
+                                    tag.resolution, tag.seed, tag.variant,
+                                    tag.parameters);
+    if constexpr (std::is_same_v<decltype(compute()), Valuation>) {
+        return cache->getOrCompute(key, compute);
+    } else {
+        return cache
+            ->getOrCompute(key,
+                           [&] {
+                               Valuation valuation;
+                               valuation.price = compute();
+                               return valuation;
+                           })
+            .price;
+    }
+}
+} // namespace
+
 // Black-Scholes Model Implementation
+namespace {
+// The closed form formulas in one accuracy tier of the math kernels.
+template <math::Accuracy A> struct ClosedForm {
+    static Price price(const options::ContractSpec &spec) {
+        Price S = spec.spotPrice;
+        Price K = spec.strikePrice;
+        Rate r = spec.interestRate;
+        double T = spec.maturity;
+        Rate sigma = spec.volatility;
+        Rate yield = spec.yield;
+        double d1 = utils::d1<A>(S, K, r, sigma, T, yield);
+        double d2 = utils::d2(d1, sigma, T);
+        return options::dispatch(spec.type, [&](auto type) {
+            constexpr double sign = options::typeSign<type()>;
+            return sign * (S * math::exp<A>(-yield * T) *
+                               math::normalCDF<A>(sign * d1) -
+                           K * math::exp<A>(-r * T) *
+                               math::normalCDF<A>(sign * d2));
+        });
+    }
+
+    static Greek delta(const options::ContractSpec &spec) {
+        Price S = spec.spotPrice;
+        Price K = spec.strikePrice;
+        Rate r = spec.interestRate;
+        double T = spec.maturity;
+        Rate sigma = spec.volatility;
+        Rate yield = spec.yield;
+        double d1 = utils::d1<A>(S, K, r, sigma, T, yield);
+        return options::dispatch(spec.type, [&](auto type) {
+            constexpr double sign = options::typeSign<type()>;
+            return sign * math::normalCDF<A>(sign * d1) *
+                   math::exp<A>(-yield * T);
+        });
+    }
+
+    static Greek gamma(const options::ContractSpec &spec) {
+        double S = spec.spotPrice;
+        double K = spec.strikePrice;
+        double r = spec.interestRate;
+        double T = spec.maturity;
+        double sigma = spec.volatility;
+        double yield = spec.yield;
+        double d1 = utils::d1<A>(S, K, r, sigma, T, yield);
+        return math::exp<A>(-yield * T) * math::normalPDF<A>(d1) /
+               (S * sigma * std::sqrt(T));
+    }
+
+    static Greek theta(const options::ContractSpec &spec) {
+        Price S = spec.spotPrice;
+        Price K = spec.strikePrice;
+        Rate r = spec.interestRate;
+        double T = spec.maturity;
+        Rate sigma = spec.volatility;
+        Rate yield = spec.yield;
+        double d1 = utils::d1<A>(S, K, r, sigma, T, yield);
+        double d2 = utils::d2(d1, sigma, T);
+        return options::dispatch(spec.type, [&](auto type) {
+            constexpr double sign = options::typeSign<type()>;
+            return (-S * math::exp<A>(-yield * T) * math::normalPDF<A>(d1) *
+                    sigma / (2 * std::sqrt(T))) +
+                   sign * ((yield * S * math::exp<A>(-yield * T) *
+                            math::normalCDF<A>(sign * d1)) -
+                           (r * K * math::exp<A>(-r * T) *
+                            math::normalCDF<A>(sign * d2)));
+        });
+    }
+
+    static Greek vega(const options::ContractSpec &spec) {
+        Price S = spec.spotPrice;
+        Price K = spec.strikePrice;
+        Rate r = spec.interestRate;
+        double T = spec.maturity;
+        Rate sigma = spec.volatility;
+        Rate yield = spec.yield;
+        double d1 = utils::d1<A>(S, K, r, sigma, T, yield);
+        return math::exp<A>(-yield * T) * math::normalPDF<A>(d1) * S *
+               std::sqrt(T);
+    }
+
+    static Greek rho(const options::ContractSpec &spec) {
+        double S = spec.spotPrice;
+        double K = spec.strikePrice;
+        double r = spec.interestRate;
+        double T = spec.maturity;
+        double sigma = spec.volatility;
+        double yield = spec.yield;
+        double d1 = utils::d1<A>(S, K, r, sigma, T, yield);
+        double d2 = utils::d2(d1, sigma, T);
+        return options::dispatch(spec.type, [&](auto type) {
+            constexpr double sign = options::typeSign<type()>;
+            return sign * T * K * math::exp<A>(-r * T) *
+                   math::normalCDF<A>(sign * d2);
+        });
+    }
+
+    static Valuation valuation(const options::ContractSpec &spec) {
+        Price S = spec.spotPrice;
+        Price K = spec.strikePrice;
+        Rate r = spec.interestRate;
+        double T = spec.maturity;
+        Rate sigma = spec.volatility;
+        Rate yield = spec.yield;
+        return options::dispatch(spec.type, [&](auto type) {
+            constexpr double sign = options::typeSign<type()>;
+            // Every Greek below is expressed through these shared
+            // intermediates, so the transcendental work is done once per
+            // contract.
+            double sqrtT = std::sqrt(T);
+            double volSqrtT = sigma * sqrtT;
+            double d1 = utils::d1<A>(S, K, r, sigma, T, yield);
+            double d2 = d1 - volSqrtT;
+            double yieldDiscount = math::exp<A>(-yield * T);
+            double rateDiscount = math::exp<A>(-r * T);
+            double pdf = math::normalPDF<A>(d1);
+            double cdf1 = math::normalCDF<A>(sign * d1);
+            double cdf2 = math::normalCDF<A>(sign * d2);
+            Price forward = S * yieldDiscount;
+            Price discountedStrike = K * rateDiscount;
+
+            Valuation valuation;
+            valuation.price =
+                sign * (forward * cdf1 - discountedStrike * cdf2);
+            valuation.delta = sign * yieldDiscount * cdf1;
+            valuation.gamma = yieldDiscount * pdf / (S * volSqrtT);
+            valuation.vega = forward * pdf * sqrtT;
+            valuation.theta = -forward * pdf * sigma / (2 * sqrtT) +
+                              sign * (yield * forward * cdf1 -
+                                      r * discountedStrike * cdf2);
+            valuation.rho = sign * T * discountedStrike * cdf2;
+            valuation.vanna = -yieldDiscount * pdf * d2 / sigma;
+            valuation.volga = valuation.vega * d1 * d2 / sigma;
+            valuation.charm = sign * yield * yieldDiscount * cdf1 -
+                              yieldDiscount * pdf *
+                                  (2 * (r - yield) * T - d2 * volSqrtT) /
+                                  (2 * T * volSqrtT);
+            return valuation;
+        });
+    }
+};
+} // namespace
+
+Price blackScholesPrice(options::ContractSpec spec, math::Accuracy accuracy) {
+    requireEuropean(spec);
+    return math::dispatch(accuracy, [&](auto accuracy) {
+        return ClosedForm<accuracy()>::price(spec);
+    });
+}
+Greek blackScholesDelta(options::ContractSpec spec, math::Accuracy accuracy) {
+    requireEuropean(spec);
+    return math::dispatch(accuracy, [&](auto accuracy) {
+        return ClosedForm<accuracy()>::delta(spec);
+    });
+}
+Greek blackScholesGamma(options::ContractSpec spec, math::Accuracy accuracy) {
+    requireEuropean(spec);
+    return math::dispatch(accuracy, [&](auto accuracy) {
+        return ClosedForm<accuracy()>::gamma(spec);
+    });
+}
+Greek blackScholesTheta(options::ContractSpec spec, math::Accuracy accuracy) {
+    requireEuropean(spec);
+    return math::dispatch(accuracy, [&](auto accuracy) {
+        return ClosedForm<accuracy()>::theta(spec);
+    });
+}
+Greek blackScholesVega(options::ContractSpec spec, math::Accuracy accuracy) {
+    requireEuropean(spec);
+    return math::dispatch(accuracy, [&](auto accuracy) {
+        return ClosedForm<accuracy()>::vega(spec);
+    });
+}
+Greek blackScholesRho(options::ContractSpec spec, math::Accuracy accuracy) {
+    requireEuropean(spec);
+    return math::dispatch(accuracy, [&](auto accuracy) {
+        return ClosedForm<accuracy()>::rho(spec);
+    });
+}
+Valuation blackScholesValuation(options::ContractSpec spec,
+                                math::Accuracy accuracy) {
+    requireEuropean(spec);
+    return math::dispatch(accuracy, [&](auto accuracy) {
+        return ClosedForm<accuracy()>::valuation(spec);
+    });
+}
+
+ClosedFormTerms blackScholesTerms(const options::ContractSpec &spec,
+                                  math::Accuracy accuracy) {
+    requireEuropean(spec);
+    return math::dispatch(accuracy, [&](auto accuracy) {
+        constexpr math::Accuracy A = accuracy();
+        double T = spec.maturity;
+        Rate sigma = spec.volatility;
+        ClosedFormTerms terms;
+        terms.volSqrtT = sigma * std::sqrt(T);
+        terms.drift =
+            ((spec.interestRate - spec.yield) + 0.5 * sigma * sigma) * T;
+        terms.rateDiscount = math::exp<A>(-spec.interestRate * T);
+        terms.yieldDiscount = math::exp<A>(-spec.yield * T);
+        return terms;
+    });
+}
+
+Price blackScholesPrice(const options::ContractSpec &spec,
+                        const ClosedFormTerms &terms,
+                        math::Accuracy accuracy) {
+    return math::dispatch(accuracy, [&](auto accuracy) {
+        constexpr math::Accuracy A = accuracy();
+        Price S = spec.spotPrice;
+        Price K = spec.strikePrice;
+        double d1 = (math::log<A>(S / K) + terms.drift) / terms.volSqrtT;
+        double d2 = d1 - terms.volSqrtT;
+        return options::dispatch(spec.type, [&](auto type) {
+            constexpr double sign = options::typeSign<type()>;
+            return sign * (S * terms.yieldDiscount *
+                               math::normalCDF<A>(sign * d1) -
+                           K * terms.rateDiscount *
+                               math::normalCDF<A>(sign * d2));
+        });
+    });
+}
+
+Rate blackScholesImpliedVolatility(options::ContractSpec spec,
+                                   Price marketPrice) {
+    requireEuropean(spec);
+    Price S = spec.spotPrice;
+    Price K = spec.strikePrice;
+    Rate r = spec.interestRate;
+    double T = spec.maturity;
+    Rate yield = spec.yield;
+    options::OptionType type = spec.type;
+    batch::OptionBookView quote;
+    quote.spot = &S;
+    quote.strike = &K;
+    quote.interestRate = &r;
+    quote.maturity = &T;
+    quote.yield = &yield;
+    quote.type = &type;
+    quote.size = 1;
+    Rate IV;
+    batch::VolatilityStatus status;
+    batch::impliedVolatility(quote, &marketPrice, &IV, &status);
+    if (status != batch::VolatilityStatus::Converged) {
+        throw std::runtime_error(
+            std::string("Implied Volatility not found (") +
+            batch::toString(status) + "). Verify parameters.");
+    }
+    return IV;
+}
+
 BlackScholesModel::BlackScholesModel(
     const std::shared_ptr<options::Option> &option)
     : m_option(option) {
@@ -22,138 +378,195 @@ BlackScholesModel::BlackScholesModel(
 }
 
 Price BlackScholesModel::calculatePrice() const {
-    Price S = m_option->getSpotPrice();
-    Price K = m_option->getStrikePrice();
-    Rate r = m_option->getInterestRate();
-    double T = m_option->getMaturity();
-    Rate sigma = m_option->getVolatility();
-    Rate yield = m_option->getYield();
-    double d1 = utils::d1(S, K, r, sigma, T, yield);
-    double d2 = utils::d2(d1, sigma, T);
-    switch (m_option->getType()) {
-    case options::OptionType::Call:
-        return S * utils::normalCDF(d1) * std::exp(-yield * T) -
-               K * std::exp(-r * T) * utils::normalCDF(d2);
-    case options::OptionType::Put:
-        return K * std::exp(-r * T) * utils::normalCDF(-d2) -
-               S * utils::normalCDF(-d1) * std::exp(-yield * T);
-    default:
-        throw std::invalid_argument("Unknown option type.");
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_cache, spec, closedFormTag(m_accuracy),
+                  cache::Quantity::Price,
+                  [&] { return blackScholesPrice(spec, m_accuracy); });
+}
+Greek BlackScholesModel::calculateDelta() const {
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_cache, spec, closedFormTag(m_accuracy),
+                  cache::Quantity::Delta,
+                  [&] { return blackScholesDelta(spec, m_accuracy); });
+}
+Greek BlackScholesModel::calculateGamma() const {
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_cache, spec, closedFormTag(m_accuracy),
+                  cache::Quantity::Gamma,
+                  [&] { return blackScholesGamma(spec, m_accuracy); });
+}
+Greek BlackScholesModel::calculateTheta() const {
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_cache, spec, closedFormTag(m_accuracy),
+                  cache::Quantity::Theta,
+                  [&] { return blackScholesTheta(spec, m_accuracy); });
+}
+Greek BlackScholesModel::calculateVega() const {
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_cache, spec, closedFormTag(m_accuracy),
+                  cache::Quantity::Vega,
+                  [&] { return blackScholesVega(spec, m_accuracy); });
+}
+Greek BlackScholesModel::calculateRho() const {
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_cache, spec, closedFormTag(m_accuracy),
+                  cache::Quantity::Rho,
+                  [&] { return blackScholesRho(spec, m_accuracy); });
+}
+Valuation BlackScholesModel::calculateValuation() const {
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_cache, spec, closedFormTag(m_accuracy),
+                  cache::Quantity::Valuation,
+                  [&] { return blackScholesValuation(spec, m_accuracy); });
+}
+Rate BlackScholesModel::calculateIV(const Price marketPrice) const {
+    return blackScholesImpliedVolatility(m_option->getSpec(), marketPrice);
+}
+// Binomial Model Implementation
+Lattice binomialLattice(const options::ContractSpec &spec, int steps) {
+    if (steps <= 0) {
+        throw std::invalid_argument(
+            "Number of steps must be a positive integer.");
     }
+    double dt = spec.maturity / steps;
+    Lattice lattice;
+    lattice.steps = steps;
+    lattice.uptick = std::exp(spec.volatility * std::sqrt(dt));
+    lattice.downtick = 1 / lattice.uptick;
+    lattice.probability =
+        (std::exp((spec.interestRate - spec.yield) * dt) - lattice.downtick) /
+        (lattice.uptick - lattice.downtick);
+    lattice.discount = std::exp(-spec.interestRate * dt);
+    return lattice;
 }
 
-Greek BlackScholesModel::calculateDelta() const {
-    Price S = m_option->getSpotPrice();
-    Price K = m_option->getStrikePrice();
-    Rate r = m_option->getInterestRate();
-    double T = m_option->getMaturity();
-    Rate sigma = m_option->getVolatility();
-    Rate yield = m_option->getYield();
-    double d1 = utils::d1(S, K, r, sigma, T, yield);
-    switch (m_option->getType()) {
-    case options::OptionType::Call:
-        return utils::normalCDF(d1) * std::exp(-yield * T);
-    case options::OptionType::Put:
-        return (utils::normalCDF(d1) - 1) * std::exp(-yield * T);
-    default:
-        throw std::invalid_argument("Unknown option type.");
+namespace {
+options::Payoff resolvePayoff(const options::ContractSpec &spec,
+                              const std::optional<options::Payoff> &payoff) {
+    if (payoff) {
+        return *payoff;
     }
+    return options::makeVanillaPayoff(spec.type, spec.strikePrice);
 }
 
-Greek BlackScholesModel::calculateGamma() const {
-    double S = m_option->getSpotPrice();
-    double K = m_option->getStrikePrice();
-    double r = m_option->getInterestRate();
-    double T = m_option->getMaturity();
-    double sigma = m_option->getVolatility();
-    double yield = m_option->getYield();
-    double d1 = utils::d1(S, K, r, sigma, T, yield);
-    return std::exp(-yield * T) * utils::normalPDF(d1) /
-           (S * sigma * std::sqrt(T));
+Price nodeSpot(const options::ContractSpec &spec, const Lattice &lattice,
+               int step, int index) {
+    return spec.spotPrice * std::pow(lattice.uptick, 2 * index - step);
 }
 
-Greek BlackScholesModel::calculateTheta() const {
-    Price S = m_option->getSpotPrice();
-    Price K = m_option->getStrikePrice();
-    Rate r = m_option->getInterestRate();
-    double T = m_option->getMaturity();
-    Rate sigma = m_option->getVolatility();
-    Rate yield = m_option->getYield();
-    double d1 = utils::d1(S, K, r, sigma, T, yield);
-    double d2 = utils::d2(d1, sigma, T);
-    switch (m_option->getType()) {
-    case options::OptionType::Call:
-        return (-S * std::exp(-yield * T) * utils::normalPDF(d1) * sigma /
-                (2 * std::sqrt(T))) +
-               (yield * S * std::exp(-yield * T) * utils::normalCDF(d1)) -
-               (r * K * std::exp(-r * T) * utils::normalCDF(d2));
-    case options::OptionType::Put:
-        return (-S * std::exp(-yield * T) * utils::normalPDF(d1) * sigma /
-                (2 * std::sqrt(T))) +
-               (yield * S * std::exp(-yield * T) * utils::normalCDF(-d1)) +
-               (r * K * std::exp(-r * T) * utils::normalCDF(-d2));
-    default:
-        throw std::invalid_argument("Unknown option type.");
+// Backward induction over steps [level, from). exercise[k] is the exercise
+// value at spot S * u^(k - steps), so node (step, index) reads
+// exercise[steps + 2 * index - step].
+template <options::ExerciseStyle Style>
+void rollback(Price *values, const Price *exercise, int steps, int from,
+              int level, double upWeight, double downWeight) {
+    for (int step = from - 1; step >= level; --step) {
+        const Price *nodeExercise = exercise + (steps - step);
+        for (int index = 0; index <= step; ++index) {
+            Price continuation =
+                upWeight * values[index + 1] + downWeight * values[index];
+            if constexpr (Style == options::ExerciseStyle::American) {
+                values[index] =
+                    std::max(continuation, nodeExercise[2 * index]);
+            } else {
+                values[index] = continuation;
+            }
+        }
     }
 }
 
-Greek BlackScholesModel::calculateVega() const {
-    Price S = m_option->getSpotPrice();
-    Price K = m_option->getStrikePrice();
-    Rate r = m_option->getInterestRate();
-    double T = m_option->getMaturity();
-    Rate sigma = m_option->getVolatility();
-    Rate yield = m_option->getYield();
-    double d1 = utils::d1(S, K, r, sigma, T, yield);
-    return std::exp(-yield * T) * utils::normalPDF(d1) * S * std::sqrt(T);
+void initialiseLattice(const options::ContractSpec &spec,
+                       const Lattice &lattice, const options::Payoff &payoff,
+                       LatticeWorkspace &workspace) {
+    // Every node spot is S * u^k for k in [-steps, steps], so the exercise
+    // values are computed once per call instead of once per node.
+    const int steps = lattice.steps;
+    double logUptick = std::log(lattice.uptick);
+    Price S = spec.spotPrice;
+    workspace.exercise.resize(2 * steps + 1);
+    workspace.values.resize(steps + 1);
+    Price *exercise = workspace.exercise.data();
+    std::visit(
+        [&](const auto &payoff) {
+            for (int k = 0; k <= 2 * steps; ++k) {
+                exercise[k] = payoff(S * std::exp((k - steps) * logUptick));
+            }
+        },
+        payoff);
+    for (int index = 0; index <= steps; ++index) {
+        workspace.values[index] = workspace.exercise[2 * index];
+    }
 }
 
-Greek BlackScholesModel::calculateRho() const {
-    double S = m_option->getSpotPrice();
-    double K = m_option->getStrikePrice();
-    double r = m_option->getInterestRate();
-    double T = m_option->getMaturity();
-    double sigma = m_option->getVolatility();
-    double yield = m_option->getYield();
-    double d1 = utils::d1(S, K, r, sigma, T, yield);
-    double d2 = utils::d2(d1, sigma, T);
-    switch (m_option->getType()) {
-    case options::OptionType::Call:
-        return T * K * std::exp(-r * T) * utils::normalCDF(d2);
-    case options::OptionType::Put:
-        return -T * K * std::exp(-r * T) * utils::normalCDF(-d2);
-    default:
-        throw std::invalid_argument("Unknown option type.");
-    }
+void rollbackLattice(const options::ContractSpec &spec,
+                     const Lattice &lattice, LatticeWorkspace &workspace,
+                     int from, int level) {
+    double upWeight = lattice.discount * lattice.probability;
+    double downWeight = lattice.discount * (1.0 - lattice.probability);
+    options::dispatch(spec.style, [&](auto style) {
+        rollback<style()>(workspace.values.data(), workspace.exercise.data(),
+                          lattice.steps, from, level, upWeight, downWeight);
+    });
 }
 
-Rate BlackScholesModel::calculateIV(const Price marketPrice) const {
-    Rate sigma = m_option->getVolatility();
-    Rate IV = 0.2;
-    constexpr int MAX_ITER = 1e3;
-    constexpr double tolerance = 1e-6;
-    for (int i = 0; i < MAX_ITER; ++i) {
-        m_option->setVolatility(IV);
-        Price theoreticalPrice = calculatePrice();
-        double delta = theoreticalPrice - marketPrice;
-        if (std::fabs(delta) < tolerance) {
-            m_option->setVolatility(sigma);
-            return IV;
-        }
-        Greek vega = calculateVega();
-        if (vega < 1e-8) {
-            break;
-        }
-        IV -= delta / vega;
-        if (IV <= 0.0) {
-            IV = tolerance;
-        }
+// Option values at level i of the tree.
+const std::vector<Price> &
+updatedPayoffs(const options::ContractSpec &spec, const Lattice &lattice,
+               const options::Payoff &payoff, LatticeWorkspace &workspace,
+               int i) {
+    initialiseLattice(spec, lattice, payoff, workspace);
+    rollbackLattice(spec, lattice, workspace, lattice.steps, i);
+    return workspace.values;
+}
+} // namespace
+
+Price binomialPrice(options::ContractSpec spec, int steps,
+                    LatticeWorkspace &workspace,
+                    const std::optional<options::Payoff> &payoff) {
+    return binomialPrice(spec, binomialLattice(spec, steps), workspace,
+                         payoff);
+}
+
+Price binomialPrice(const options::ContractSpec &spec, const Lattice &lattice,
+                    LatticeWorkspace &workspace,
+                    const std::optional<options::Payoff> &payoff) {
+    return updatedPayoffs(spec, lattice, resolvePayoff(spec, payoff),
+                          workspace, 0)[0];
+}
+
+Valuation binomialValuation(options::ContractSpec spec, int steps,
+                            LatticeWorkspace &workspace,
+                            const std::optional<options::Payoff> &payoff) {
+    if (steps < 2) {
+        throw std::invalid_argument(
+            "Binomial Greeks require at least two steps.");
     }
-    m_option->setVolatility(sigma);
-    throw std::runtime_error(
-        "Implied Volatility did not converge. Verify parameters.");
+    Lattice lattice = binomialLattice(spec, steps);
+    // One rollback, pausing at levels 2 and 1 to keep the nodes the root
+    // Greeks are differenced from.
+    initialiseLattice(spec, lattice, resolvePayoff(spec, payoff), workspace);
+    rollbackLattice(spec, lattice, workspace, steps, 2);
+    Price v20 = workspace.values[0], v21 = workspace.values[1],
+          v22 = workspace.values[2];
+    rollbackLattice(spec, lattice, workspace, 2, 1);
+    Price v10 = workspace.values[0], v11 = workspace.values[1];
+    rollbackLattice(spec, lattice, workspace, 1, 0);
+
+    Price S = spec.spotPrice;
+    Price sUp = S * lattice.uptick, sDown = S * lattice.downtick;
+    Price sUpUp = sUp * lattice.uptick, sDownDown = sDown * lattice.downtick;
+    double dt = spec.maturity / steps;
+
+    Valuation valuation;
+    valuation.price = workspace.values[0];
+    valuation.delta = (v11 - v10) / (sUp - sDown);
+    Greek deltaUp = (v22 - v21) / (sUpUp - S);
+    Greek deltaDown = (v21 - v20) / (S - sDownDown);
+    valuation.gamma = (deltaUp - deltaDown) / (0.5 * (sUpUp - sDownDown));
+    valuation.theta = (v21 - valuation.price) / (2 * dt);
+    return valuation;
 }
-// Binomial Model Implementation
+
 BinomialModel::BinomialModel(const std::shared_ptr<options::Option> option,
                              const int &steps)
     : m_option(option), m_steps(steps) {
@@ -164,83 +577,70 @@ BinomialModel::BinomialModel(const std::shared_ptr<options::Option> option,
         throw std::invalid_argument(
             "Number of steps must be a positive integer.");
     }
-    m_uptick =
-        exp(option->getVolatility() * sqrt(option->getMaturity() / steps));
-    m_downtick = 1 / m_uptick;
-    m_probability = (exp((option->getInterestRate() - option->getYield()) *
-                         (option->getMaturity() / steps)) -
-                     m_downtick) /
-                    (m_uptick - m_downtick);
 }
 int BinomialModel::getSteps() const { return m_steps; }
-double BinomialModel::getUptick() const { return m_uptick; }
-double BinomialModel::getDowntick() const { return m_downtick; }
-double BinomialModel::getProbability() const { return m_probability; }
-Price BinomialModel::calculatePrice() const { return getUpdatedPayoffs(0)[0]; }
-std::vector<Price> BinomialModel::getPayoffs() const {
-    std::vector<Price> payoffs(m_steps + 1);
-    for (int i = 0; i <= m_steps; i++) {
-        Price ST = m_option->getSpotPrice() * pow(m_uptick, i) *
-                   pow(m_downtick, m_steps - i);
-        if (m_option->getType() == options::OptionType::Call) {
-            payoffs[i] = std::max(ST - m_option->getStrikePrice(), 0.0);
-        } else {
-            payoffs[i] = std::max(m_option->getStrikePrice() - ST, 0.0);
-        }
-    }
-    return payoffs;
+double BinomialModel::getUptick() const {
+    return binomialLattice(m_option->getSpec(), m_steps).uptick;
 }
-std::vector<Price> BinomialModel::getUpdatedPayoffs(int i) const {
-    auto payoffs = getPayoffs();
-    for (int step = m_steps - 1; step >= i; --step) {
-        for (int index = 0; index <= step; ++index) {
-            Price ST = m_option->getSpotPrice() * pow(m_uptick, index) *
-                       pow(m_downtick, step - index);
-            switch (m_option->getStyle()) {
-            case (options::ExerciseStyle::American):
-                if (m_option->getType() == options::OptionType::Call) {
-                    payoffs[index] = std::max(
-                        std::max(exp(-m_option->getInterestRate() *
-                                     m_option->getMaturity() / m_steps) *
-                                     (m_probability * payoffs[index + 1] +
-                                      (1.0 - m_probability) * payoffs[index]),
-                                 0.0),
-                        ST - m_option->getStrikePrice());
-                } else {
-                    payoffs[index] = std::max(
-                        std::max(exp(-m_option->getInterestRate() *
-                                     m_option->getMaturity() / m_steps) *
-                                     (m_probability * payoffs[index + 1] +
-                                      (1.0 - m_probability) * payoffs[index]),
-                                 0.0),
-                        m_option->getStrikePrice() - ST);
-                }
-                break;
-            case (options::ExerciseStyle::European):
-                payoffs[index] = exp(-m_option->getInterestRate() *
-                                     m_option->getMaturity() / m_steps) *
-                                 (m_probability * payoffs[index + 1] +
-                                  (1.0 - m_probability) * payoffs[index]);
-                break;
-            default:
-                throw std::invalid_argument("Unknown option exercise style.");
-            }
-        }
+double BinomialModel::getDowntick() const {
+    return binomialLattice(m_option->getSpec(), m_steps).downtick;
+}
+double BinomialModel::getProbability() const {
+    return binomialLattice(m_option->getSpec(), m_steps).probability;
+}
+Price BinomialModel::calculatePrice() const {
+    LatticeWorkspace workspace;
+    return calculatePrice(workspace);
+}
+Price BinomialModel::calculatePrice(LatticeWorkspace &workspace) const {
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_payoff ? nullptr : m_cache, spec,
+                  latticeTag(m_steps, m_lattice), cache::Quantity::Price,
+                  [&] {
+                      return latticePrice(spec, m_steps, m_lattice,
+                                          workspace, m_payoff);
+                  });
+}
+void BinomialModel::setPayoff(std::optional<options::Payoff> payoff) {
+    m_payoff = std::move(payoff);
+}
+options::Payoff BinomialModel::getPayoff() const {
+    return resolvePayoff(m_option->getSpec(), m_payoff);
+}
+
+Valuation BinomialModel::calculateValuation() const {
+    LatticeWorkspace workspace;
+    return calculateValuation(workspace);
+}
+
+Valuation
+BinomialModel::calculateValuation(LatticeWorkspace &workspace) const {
+    if (!(m_lattice == LatticeSettings{})) {
+        throw std::invalid_argument(
+            "Lattice Greeks need the plain Cox-Ross-Rubinstein tree.");
     }
-    return payoffs;
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_payoff ? nullptr : m_cache, spec,
+                  latticeTag(m_steps, m_lattice), cache::Quantity::Valuation,
+                  [&] {
+                      return binomialValuation(spec, m_steps, workspace,
+                                               m_payoff);
+                  });
 }
 
 Greek BinomialModel::calculateDelta(int i, int j) const {
     if (i < 0 || i >= m_steps || j < 0 || j > i) {
         throw std::out_of_range("Invalid indices for delta calculation.");
     }
-    auto updatedPayoffs = getUpdatedPayoffs(i + 1);
-    Price cU = updatedPayoffs[j + 1];
-    Price cD = updatedPayoffs[j];
-    Price sU = m_option->getSpotPrice() * pow(m_uptick, j + 1) *
-               pow(m_downtick, i - j - 1);
-    Price sD =
-        m_option->getSpotPrice() * pow(m_uptick, j) * pow(m_downtick, i - j);
+    options::ContractSpec spec = m_option->getSpec();
+    Lattice lattice = binomialLattice(spec, m_steps);
+    LatticeWorkspace workspace;
+    const auto &values = updatedPayoffs(
+        spec, lattice, resolvePayoff(spec, m_payoff), workspace, i + 1);
+    Price cU = values[j + 1];
+    Price cD = values[j];
+    Price sU = nodeSpot(spec, lattice, i + 1, j + 1);
+    Price sD = nodeSpot(spec, lattice, i + 1, j);
     return (cU - cD) / (sU - sD);
 }
 
@@ -248,12 +648,12 @@ Greek BinomialModel::calculateGamma(int i, int j) const {
     if (i < 0 || i >= m_steps - 1 || j < 0 || j > i) {
         throw std::out_of_range("Invalid indices for gamma calculation.");
     }
+    options::ContractSpec spec = m_option->getSpec();
+    Lattice lattice = binomialLattice(spec, m_steps);
     Greek deltaU = calculateDelta(i + 1, j + 1);
     Greek deltaD = calculateDelta(i + 1, j);
-    Price sUU = m_option->getSpotPrice() * pow(m_uptick, j + 2) *
-                pow(m_downtick, i - j);
-    Price sDD = m_option->getSpotPrice() * pow(m_uptick, j) *
-                pow(m_downtick, i - j + 2);
+    Price sUU = nodeSpot(spec, lattice, i + 2, j + 2);
+    Price sDD = nodeSpot(spec, lattice, i + 2, j);
     return (deltaU - deltaD) / (0.5 * (sUU - sDD));
 }
 
@@ -261,127 +661,606 @@ Greek BinomialModel::calculateTheta(int i, int j) const {
     if (i < 0 || i >= m_steps - 1 || j < 0 || j > i) {
         throw std::out_of_range("Invalid indices for theta calculation.");
     }
-    auto payoffs1 = getUpdatedPayoffs(i);
-    auto payoffs2 = getUpdatedPayoffs(i + 2);
-    Price cU = payoffs1[j];
-    Price cD = payoffs2[j + 1];
-    return (cU - cD) / (365 * m_option->getMaturity() / m_steps);
+    options::ContractSpec spec = m_option->getSpec();
+    Lattice lattice = binomialLattice(spec, m_steps);
+    options::Payoff payoff = resolvePayoff(spec, m_payoff);
+    LatticeWorkspace workspace;
+    Price cU = updatedPayoffs(spec, lattice, payoff, workspace, i)[j];
+    Price cD = updatedPayoffs(spec, lattice, payoff, workspace, i + 2)[j + 1];
+    return (cU - cD) / (365 * spec.maturity / m_steps);
 }
 
 void BinomialModel::setOption(const std::shared_ptr<options::Option> &option) {
-    m_option = option;
-    if (!m_option) {
+    if (!option) {
         throw std::invalid_argument("Option cannot be null.");
     }
-    m_uptick =
-        exp(option->getVolatility() * sqrt(option->getMaturity() / m_steps));
-    m_downtick = 1 / m_uptick;
-    m_probability =
-        (exp(option->getInterestRate() -
-             option->getYield() * (option->getMaturity() / m_steps)) -
-         m_downtick) /
-        (m_uptick - m_downtick);
+    m_option = option;
+}
+
+namespace {
+// Paths are generated, priced and reduced in blocks, and each block owns
+// one Philox stream. Blocks are grouped into fixed size tasks whose
+// accumulators are merged in task order, so results depend only on the seed
+// and the path count.
+constexpr std::size_t monteCarloBlockSize = 4096;
+constexpr std::size_t monteCarloBlocksPerTask = 16;
+
+// Calls body(accumulator, normals, count) for every block of paths, where
+// normals holds the block's standard normal draws and may be overwritten.
+template <typename Accumulator, typename Body>
+Accumulator simulateBlocks(std::uint64_t seed, std::size_t paths,
+                           unsigned threads, const Body &body) {
+    const rng::Philox4x32 generator(seed);
+    const std::size_t blocks =
+        (paths + monteCarloBlockSize - 1) / monteCarloBlockSize;
+    const std::size_t tasks =
+        (blocks + monteCarloBlocksPerTask - 1) / monteCarloBlocksPerTask;
+    std::vector<Accumulator> taskAccumulators(tasks);
+    parallel::ThreadPool::shared().parallelFor(
+        tasks,
+        [&](std::size_t task) {
+            std::array<double, monteCarloBlockSize> normals;
+            std::size_t end =
+                std::min(blocks, (task + 1) * monteCarloBlocksPerTask);
+            for (std::size_t block = task * monteCarloBlocksPerTask;
+                 block < end; ++block) {
+                std::size_t count = std::min(
+                    monteCarloBlockSize, paths - block * monteCarloBlockSize);
+                rng::fillNormals(generator, block, normals.data(), count);
+                body(taskAccumulators[task], normals.data(), count);
+            }
+        },
+        threads);
+    Accumulator total;
+    for (const auto &accumulator : taskAccumulators) {
+        total.merge(accumulator);
+    }
+    return total;
+}
+
+// Sums of the discounted-payoff derivatives with respect to the terminal
+// spot, one per Greek; see MonteCarloModel::calculateValuation.
+struct GreekSums {
+    utils::RunningStats payoff;
+    double delta{0.0};
+    double gamma{0.0};
+    double vega{0.0};
+    double rho{0.0};
+    double theta{0.0};
+    void merge(const GreekSums &other) {
+        payoff.merge(other.payoff);
+        delta += other.delta;
+        gamma += other.gamma;
+        vega += other.vega;
+        rho += other.rho;
+        theta += other.theta;
+    }
+};
+
+// Risk neutral terminal spot S_T = S0 exp(drift + diffusion Z) and the
+// payoff on it. The estimators below are instantiated per payoff type, so
+// their loops carry no type or payoff branches.
+template <typename Payoff> struct TerminalPayoff {
+    Price spot;
+    double drift;
+    double diffusion;
+    Payoff payoff;
+    Price terminalSpot(double Z) const {
+        return spot * std::exp(drift + diffusion * Z);
+    }
+    Price operator()(double Z) const { return payoff(terminalSpot(Z)); }
+};
+
+constexpr double z95 = 1.959963984540054;
+
+// Discounts an undiscounted mean and its error. The reduction factor
+// compares the variance of a plain estimator over the same number of
+// payoff evaluations with the variance actually achieved.
+MonteCarloEstimate makeEstimate(double mean, double standardError,
+                                double plainVariance, std::size_t paths,
+                                double discount) {
+    MonteCarloEstimate estimate;
+    estimate.paths = paths;
+    estimate.price = discount * mean;
+    estimate.standardError = discount * standardError;
+    estimate.lowerBound = estimate.price - z95 * estimate.standardError;
+    estimate.upperBound = estimate.price + z95 * estimate.standardError;
+    double achieved = standardError * standardError;
+    estimate.varianceReductionFactor =
+        achieved > 0.0 ? plainVariance / paths / achieved : 1.0;
+    return estimate;
+}
+
+template <typename Payoff>
+MonteCarloEstimate estimatePlain(const TerminalPayoff<Payoff> &payoff,
+                                 std::uint64_t seed, std::size_t paths,
+                                 unsigned threads, double discount) {
+    auto stats = simulateBlocks<utils::RunningStats>(
+        seed, paths, threads,
+        [&](utils::RunningStats &accumulator, double *values,
+            std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) {
+                values[i] = payoff(values[i]);
+            }
+            accumulator.addBlock(values, count);
+        });
+    return makeEstimate(stats.mean(),
+                        std::sqrt(stats.variance() / stats.count()),
+                        stats.variance(), stats.count(), discount);
+}
+
+struct AntitheticStats {
+    utils::RunningStats pairs;
+    utils::RunningStats payoffs;
+    void merge(const AntitheticStats &other) {
+        pairs.merge(other.pairs);
+        payoffs.merge(other.payoffs);
+    }
+};
+
+// Each normal Z is paired with -Z, so paths / 2 draws give paths payoffs.
+template <typename Payoff>
+MonteCarloEstimate estimateAntithetic(const TerminalPayoff<Payoff> &payoff,
+                                      std::uint64_t seed, std::size_t paths,
+                                      unsigned threads, double discount) {
+    auto stats = simulateBlocks<AntitheticStats>(
+        seed, (paths + 1) / 2, threads,
+        [&](AntitheticStats &accumulator, double *values, std::size_t count) {
+            std::array<double, monteCarloBlockSize> mirrored;
+            for (std::size_t i = 0; i < count; ++i) {
+                mirrored[i] = payoff(-values[i]);
+                values[i] = payoff(values[i]);
+            }
+            accumulator.payoffs.addBlock(values, count);
+            accumulator.payoffs.addBlock(mirrored.data(), count);
+            for (std::size_t i = 0; i < count; ++i) {
+                values[i] = 0.5 * (values[i] + mirrored[i]);
+            }
+            accumulator.pairs.addBlock(values, count);
+        });
+    return makeEstimate(
+        stats.pairs.mean(),
+        std::sqrt(stats.pairs.variance() / stats.pairs.count()),
+        stats.payoffs.variance(), stats.payoffs.count(), discount);
+}
+
+// The terminal spot is the control: its risk neutral mean is known exactly,
+// and it is strongly correlated with the payoff. The coefficient is the
+// regression slope estimated from the same paths.
+template <typename Payoff>
+MonteCarloEstimate
+estimateControlVariate(const TerminalPayoff<Payoff> &payoff, Price forward,
+                       std::uint64_t seed, std::size_t paths,
+                       unsigned threads, double discount) {
+    auto stats = simulateBlocks<utils::RunningCovariance>(
+        seed, paths, threads,
+        [&](utils::RunningCovariance &accumulator, double *values,
+            std::size_t count) {
+            std::array<double, monteCarloBlockSize> controls;
+            for (std::size_t i = 0; i < count; ++i) {
+                controls[i] = payoff.terminalSpot(values[i]);
+                values[i] = payoff.payoff(controls[i]);
+            }
+            accumulator.addBlock(values, controls.data(), count);
+        });
+    double beta = stats.varianceY() > 0.0
+                      ? stats.covariance() / stats.varianceY()
+                      : 0.0;
+    double mean = stats.meanX() - beta * (stats.meanY() - forward);
+    double residual = std::max(stats.varianceX() - beta * stats.covariance(),
+                               0.0);
+    return makeEstimate(mean, std::sqrt(residual / stats.count()),
+                        stats.varianceX(), stats.count(), discount);
+}
+
+// Randomised quasi Monte Carlo: the same Sobol points under independent
+// digital shifts, one replication per task. The error is measured across
+// replications. A terminal-only path needs a single dimension, which is the
+// first point of a Brownian bridge construction.
+template <typename Payoff>
+MonteCarloEstimate estimateQuasiRandom(const TerminalPayoff<Payoff> &payoff,
+                                       std::uint64_t seed, std::size_t paths,
+                                       unsigned threads, double discount) {
+    constexpr std::size_t replications = 16;
+    const std::size_t points = (paths + replications - 1) / replications;
+    std::vector<utils::RunningStats> replicationStats(replications);
+    parallel::ThreadPool::shared().parallelFor(
+        replications,
+        [&](std::size_t replication) {
+            rng::SobolSequence sequence(1, seed, replication);
+            std::array<double, monteCarloBlockSize> values;
+            for (std::size_t begin = 0; begin < points;
+                 begin += monteCarloBlockSize) {
+                std::size_t count =
+                    std::min(monteCarloBlockSize, points - begin);
+                for (std::size_t i = 0; i < count; ++i) {
+                    double u;
+                    sequence.next(&u);
+                    values[i] = payoff(utils::inverseNormalCDF(u));
+                }
+                replicationStats[replication].addBlock(values.data(), count);
+            }
+        },
+        threads);
+    utils::RunningStats means, payoffs;
+    for (const auto &stats : replicationStats) {
+        means.add(stats.mean());
+        payoffs.merge(stats);
+    }
+    return makeEstimate(means.mean(),
+                        std::sqrt(means.variance() / replications),
+                        payoffs.variance(), payoffs.count(), discount);
+}
+
+// With S_T = S0 exp(drift + diffusion Z) and g = dPayoff/dS_T, every
+// pathwise Greek is g times the derivative of S_T. Gamma differentiates
+// the pathwise delta g S_T / S0 once more through the likelihood ratio
+// of S_T, which avoids the second derivative of the kinked payoff.
+template <typename Payoff>
+Valuation pathwiseValuation(const Payoff &payoff,
+                            const options::ContractSpec &spec,
+                            const MonteCarloSettings &settings,
+                            MonteCarloEstimate *estimate) {
+    if constexpr (!Payoff::pathwise) {
+        throw std::invalid_argument(
+            "Pathwise Greeks need a payoff that is continuous in the spot.");
+    } else {
+        Price S0 = spec.spotPrice;
+        Rate sigma = spec.volatility;
+        Rate yield = spec.yield;
+        Rate r = spec.interestRate;
+        double T = spec.maturity;
+        const int paths = settings.paths;
+        double sqrtT = std::sqrt(T);
+        double driftRate = r - yield - 0.5 * sigma * sigma;
+        double drift = driftRate * T;
+        double diffusion = sigma * sqrtT;
+
+        auto sums = simulateBlocks<GreekSums>(
+            settings.seed, paths, settings.threads,
+            [&](GreekSums &accumulator, double *values, std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    double Z = values[i];
+                    Price ST = S0 * std::exp(drift + diffusion * Z);
+                    double gST = payoff.derivative(ST) * ST;
+                    accumulator.delta += gST;
+                    accumulator.gamma += gST * (Z / diffusion - 1.0);
+                    accumulator.vega += gST * (sqrtT * Z - sigma * T);
+                    accumulator.rho += gST;
+                    accumulator.theta +=
+                        gST * (driftRate + 0.5 * sigma * Z / sqrtT);
+                    values[i] = payoff(ST);
+                }
+                accumulator.payoff.addBlock(values, count);
+            });
+
+        double discount = std::exp(-r * T);
+        double scale = discount / paths;
+        Valuation valuation;
+        valuation.price = discount * sums.payoff.mean();
+        valuation.delta = scale * sums.delta / S0;
+        valuation.gamma = scale * sums.gamma / (S0 * S0);
+        valuation.vega = scale * sums.vega;
+        valuation.rho = scale * sums.rho * T - T * valuation.price;
+        valuation.theta = r * valuation.price - scale * sums.theta;
+        if (estimate) {
+            double variance = sums.payoff.variance();
+            *estimate = makeEstimate(
+                sums.payoff.mean(),
+                std::sqrt(variance / sums.payoff.count()), variance,
+                sums.payoff.count(), discount);
+        }
+        return valuation;
+    }
+}
+
+void checkPaths(const MonteCarloSettings &settings) {
+    if (settings.paths <= 0) {
+        throw std::invalid_argument(
+            "N.o of iterations must be a positive integer.");
+    }
+}
+
+// Prices of bumped copies of spec with the same seed, so every copy sees
+// the same paths (common random numbers). American copies are exercised on
+// the rule fitted to spec rather than refitted, so their differences carry
+// no regression noise.
+std::vector<Price> reprice(const options::ContractSpec &spec,
+                           const std::vector<options::ContractSpec> &bumped,
+                           const MonteCarloSettings &settings,
+                           const std::optional<options::Payoff> &payoff) {
+    if (spec.style == options::ExerciseStyle::American) {
+        std::vector<Price> prices =
+            longstaffSchwartzRevalue(spec, bumped, settings, payoff);
+        prices.erase(prices.begin());
+        return prices;
+    }
+    std::vector<Price> prices;
+    for (const options::ContractSpec &copy : bumped) {
+        prices.push_back(monteCarloEstimate(copy, settings, payoff).price);
+    }
+    return prices;
+}
+
+// Central difference of the price in one input. Bumps are a fraction of the
+// bumped input rather than a fixed step.
+template <typename Bump>
+Greek centralDifference(const options::ContractSpec &spec, double h,
+                        const MonteCarloSettings &settings,
+                        const std::optional<options::Payoff> &payoff,
+                        const Bump &bump) {
+    options::ContractSpec up = spec, down = spec;
+    bump(up, h);
+    bump(down, -h);
+    std::vector<Price> prices = reprice(spec, {up, down}, settings, payoff);
+    return (prices[0] - prices[1]) / (2.0 * h);
+}
+
+// Price, delta, vega and rho of an American contract, every bump revalued
+// on the exercise rule of one Longstaff-Schwartz fit. Gamma and theta are
+// NaN; see MonteCarloModel::calculateValuation.
+Valuation bumpedValuation(const options::ContractSpec &spec,
+                          const MonteCarloSettings &settings,
+                          const std::optional<options::Payoff> &payoff,
+                          MonteCarloEstimate *estimate) {
+    double hS = utils::bumpSize(spec.spotPrice);
+    double hSigma = utils::bumpSize(spec.volatility);
+    double hR = utils::bumpSize(spec.interestRate, utils::minimumRateBump);
+    std::vector<options::ContractSpec> bumped(6, spec);
+    bumped[0].spotPrice += hS;
+    bumped[1].spotPrice -= hS;
+    bumped[2].volatility += hSigma;
+    bumped[3].volatility -= hSigma;
+    bumped[4].interestRate += hR;
+    bumped[5].interestRate -= hR;
+    std::vector<Price> prices =
+        longstaffSchwartzRevalue(spec, bumped, settings, payoff, estimate);
+    Valuation valuation;
+    valuation.price = prices[0];
+    valuation.delta = (prices[1] - prices[2]) / (2.0 * hS);
+    valuation.gamma = std::numeric_limits<double>::quiet_NaN();
+    valuation.theta = std::numeric_limits<double>::quiet_NaN();
+    valuation.vega = (prices[3] - prices[4]) / (2.0 * hSigma);
+    valuation.rho = (prices[5] - prices[6]) / (2.0 * hR);
+    return valuation;
+}
+} // namespace
+
+MonteCarloEstimate
+monteCarloEstimate(options::ContractSpec spec,
+                   const MonteCarloSettings &settings,
+                   const std::optional<options::Payoff> &payoff) {
+    if (spec.style == options::ExerciseStyle::American) {
+        return longstaffSchwartzEstimate(spec, settings, payoff);
+    }
+    checkPaths(settings);
+    Price S0 = spec.spotPrice;
+    Rate sigma = spec.volatility;
+    Rate yield = spec.yield;
+    Rate r = spec.interestRate;
+    double T = spec.maturity;
+    double drift = (r - yield - 0.5 * sigma * sigma) * T;
+    double diffusion = sigma * std::sqrt(T);
+    double discount = std::exp(-r * T);
+    const std::uint64_t seed = settings.seed;
+    const std::size_t paths = settings.paths;
+    const unsigned threads = settings.threads;
+    return std::visit(
+        [&](const auto &terminal) {
+            TerminalPayoff<std::decay_t<decltype(terminal)>> terminalPayoff{
+                S0, drift, diffusion, terminal};
+            switch (settings.varianceReduction) {
+            case VarianceReduction::None:
+                return estimatePlain(terminalPayoff, seed, paths, threads,
+                                     discount);
+            case VarianceReduction::Antithetic:
+                return estimateAntithetic(terminalPayoff, seed, paths,
+                                          threads, discount);
+            case VarianceReduction::ControlVariate:
+                return estimateControlVariate(
+                    terminalPayoff, S0 * std::exp((r - yield) * T), seed,
+                    paths, threads, discount);
+            case VarianceReduction::QuasiRandom:
+                return estimateQuasiRandom(terminalPayoff, seed, paths,
+                                           threads, discount);
+            default:
+                throw std::invalid_argument(
+                    "Unknown variance reduction mode.");
+            }
+        },
+        resolvePayoff(spec, payoff));
+}
+
+Valuation monteCarloValuation(options::ContractSpec spec,
+                              const MonteCarloSettings &settings,
+                              const std::optional<options::Payoff> &payoff,
+                              MonteCarloEstimate *estimate) {
+    if (spec.style == options::ExerciseStyle::American) {
+        return bumpedValuation(spec, settings, payoff, estimate);
+    }
+    checkPaths(settings);
+    // The pathwise Greeks are taken on plain paths, so only a plain estimate
+    // comes from the same run.
+    bool plain = settings.varianceReduction == VarianceReduction::None;
+    Valuation valuation = std::visit(
+        [&](const auto &terminal) {
+            return pathwiseValuation(terminal, spec, settings,
+                                     plain ? estimate : nullptr);
+        },
+        resolvePayoff(spec, payoff));
+    if (estimate && !plain) {
+        *estimate = monteCarloEstimate(spec, settings, payoff);
+    }
+    return valuation;
+}
+
+Greek monteCarloDelta(options::ContractSpec spec,
+                      const MonteCarloSettings &settings,
+                      const std::optional<options::Payoff> &payoff) {
+    return centralDifference(
+        spec, utils::bumpSize(spec.spotPrice), settings, payoff,
+        [](options::ContractSpec &bumped, double h) {
+            bumped.spotPrice += h;
+        });
+}
+Greek monteCarloGamma(options::ContractSpec spec,
+                      const MonteCarloSettings &settings,
+                      const std::optional<options::Payoff> &payoff) {
+    double h = utils::bumpSize(spec.spotPrice);
+    options::ContractSpec up = spec, down = spec;
+    up.spotPrice += h;
+    down.spotPrice -= h;
+    std::vector<Price> prices =
+        reprice(spec, {spec, up, down}, settings, payoff);
+    return (prices[1] - 2 * prices[0] + prices[2]) / (h * h);
+}
+Greek monteCarloTheta(options::ContractSpec spec,
+                      const MonteCarloSettings &settings,
+                      const std::optional<options::Payoff> &payoff) {
+    double h = utils::bumpSize(spec.maturity);
+    options::ContractSpec down = spec;
+    down.maturity -= h;
+    std::vector<Price> prices = reprice(spec, {spec, down}, settings, payoff);
+    return (prices[1] - prices[0]) / h;
+}
+Greek monteCarloVega(options::ContractSpec spec,
+                     const MonteCarloSettings &settings,
+                     const std::optional<options::Payoff> &payoff) {
+    return centralDifference(
+        spec, utils::bumpSize(spec.volatility), settings, payoff,
+        [](options::ContractSpec &bumped, double h) {
+            bumped.volatility += h;
+        });
+}
+Greek monteCarloRho(options::ContractSpec spec,
+                    const MonteCarloSettings &settings,
+                    const std::optional<options::Payoff> &payoff) {
+    return centralDifference(
+        spec, utils::bumpSize(spec.interestRate, utils::minimumRateBump),
+        settings, payoff, [](options::ContractSpec &bumped, double h) {
+            bumped.interestRate += h;
+        });
 }
 
 MonteCarloModel::MonteCarloModel(const std::shared_ptr<options::Option> &option,
-                                 const int &N)
-    : m_option(option), m_N(N) {
-    if (N < 0) {
+                                 const int &N, std::uint64_t seed)
+    : m_option(option) {
+    if (N <= 0) {
         throw std::invalid_argument(
             "N.o of iterations must be a positive integer.");
     }
     if (!m_option) {
         throw std::invalid_argument("Option cannot be null.");
     }
-    if (option->getStyle() == options::ExerciseStyle::American) {
-        throw std::invalid_argument("Option exercise style must be European");
-    }
+    m_settings.paths = N;
+    m_settings.seed = seed;
 }
-std::vector<Price> MonteCarloModel::getStockPrices() const {
-    std::vector<Price> stockPrices(m_N);
-    auto Z = utils::generateSamples(m_N);
-    Price S0 = m_option->getSpotPrice();
-    Rate sigma = m_option->getVolatility();
-    Rate yield = m_option->getYield();
-    Rate r = m_option->getInterestRate();
-    double T = m_option->getMaturity();
-    for (int i = 0; i < m_N; ++i) {
-        stockPrices[i] = S0 * std::exp((r - yield - 0.5 * sigma * sigma) * T +
-                                       sigma * std::sqrt(T) * Z[i]);
-    }
-    return stockPrices;
-}
-std::vector<Price> MonteCarloModel::getPayoffs() const {
-    std::vector<Price> payoffs(m_N);
-    auto stockPrices = getStockPrices();
-    Price K = m_option->getStrikePrice();
-    switch (m_option->getType()) {
-    case (options::OptionType::Call):
-        for (int i = 0; i < m_N; ++i) {
-            payoffs[i] = std::max(stockPrices[i] - K, 0.0);
-        }
-        break;
-    case (options::OptionType::Put):
-        for (int i = 0; i < m_N; ++i) {
-            payoffs[i] = std::max(K - stockPrices[i], 0.0);
-        }
-        break;
-    default:
-        throw std::invalid_argument("Unknown option type.");
-    }
-    return payoffs;
+options::Payoff MonteCarloModel::getPayoff() const {
+    return resolvePayoff(m_option->getSpec(), m_payoff);
+}
+MonteCarloEstimate MonteCarloModel::calculateEstimate() const {
+    return monteCarloEstimate(m_option->getSpec(), m_settings, m_payoff);
 }
 Price MonteCarloModel::calculatePrice() const {
-    auto payoffs = getPayoffs();
-    Rate r = m_option->getInterestRate();
-    double T = m_option->getMaturity();
-    return std::exp(-r * T) *
-           (std::accumulate(payoffs.begin(), payoffs.end(), 0.0) / m_N);
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_payoff ? nullptr : m_cache, spec,
+                  monteCarloTag(m_settings), cache::Quantity::Price, [&] {
+                      return monteCarloEstimate(spec, m_settings, m_payoff)
+                          .price;
+                  });
+}
+Valuation MonteCarloModel::calculateValuation() const {
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_payoff ? nullptr : m_cache, spec,
+                  monteCarloTag(m_settings), cache::Quantity::Valuation,
+                  [&] {
+                      return monteCarloValuation(spec, m_settings, m_payoff);
+                  });
 }
 Greek MonteCarloModel::calculateDelta() const {
-    Price spotPrice = m_option->getSpotPrice();
-    m_option->setSpotPrice(spotPrice + utils::stepSize);
-    Price priceUp = calculatePrice();
-    m_option->setSpotPrice(spotPrice - utils::stepSize);
-    Price priceDown = calculatePrice();
-    m_option->setSpotPrice(spotPrice);
-    return (priceUp - priceDown) / (2.0 * utils::stepSize);
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_payoff ? nullptr : m_cache, spec,
+                  monteCarloTag(m_settings), cache::Quantity::Delta,
+                  [&] { return monteCarloDelta(spec, m_settings, m_payoff); });
 }
 Greek MonteCarloModel::calculateGamma() const {
-    Price spotPrice = m_option->getSpotPrice();
-    Price price = calculatePrice();
-    m_option->setSpotPrice(spotPrice + utils::stepSize);
-    Price priceUp = calculatePrice();
-    m_option->setSpotPrice(spotPrice - utils::stepSize);
-    Price priceDown = calculatePrice();
-    m_option->setSpotPrice(spotPrice);
-    return (priceUp - 2 * price + priceDown) /
-           (utils::stepSize * utils::stepSize);
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_payoff ? nullptr : m_cache, spec,
+                  monteCarloTag(m_settings), cache::Quantity::Gamma,
+                  [&] { return monteCarloGamma(spec, m_settings, m_payoff); });
 }
 Greek MonteCarloModel::calculateTheta() const {
-    double maturity = m_option->getMaturity();
-    Price price = calculatePrice();
-    m_option->setMaturity(maturity - utils::stepSize);
-    Price priceDown = calculatePrice();
-    m_option->setMaturity(maturity);
-    return (priceDown - price) / utils::stepSize;
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_payoff ? nullptr : m_cache, spec,
+                  monteCarloTag(m_settings), cache::Quantity::Theta,
+                  [&] { return monteCarloTheta(spec, m_settings, m_payoff); });
 }
 Greek MonteCarloModel::calculateVega() const {
-    Rate sigma = m_option->getVolatility();
-    m_option->setVolatility(sigma + utils::stepSize);
-    Price priceUp = calculatePrice();
-    m_option->setVolatility(sigma - utils::stepSize);
-    Price priceDown = calculatePrice();
-    m_option->setVolatility(sigma);
-    return (priceUp - priceDown) / (2.0 * utils::stepSize);
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_payoff ? nullptr : m_cache, spec,
+                  monteCarloTag(m_settings), cache::Quantity::Vega,
+                  [&] { return monteCarloVega(spec, m_settings, m_payoff); });
 }
 Greek MonteCarloModel::calculateRho() const {
-    Rate interestRate = m_option->getInterestRate();
-    m_option->setInterestRate(interestRate + utils::stepSize);
-    Price priceUp = calculatePrice();
-    m_option->setInterestRate(interestRate - utils::stepSize);
-    Price priceDown = calculatePrice();
-    m_option->setInterestRate(interestRate);
-    return (priceUp - priceDown) / (2.0 * utils::stepSize);
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_payoff ? nullptr : m_cache, spec,
+                  monteCarloTag(m_settings), cache::Quantity::Rho,
+                  [&] { return monteCarloRho(spec, m_settings, m_payoff); });
+}
+
+AmericanApproximationModel::AmericanApproximationModel(
+    const std::shared_ptr<options::Option> &option,
+    const AmericanSettings &settings)
+    : m_option(option), m_settings(settings) {
+    if (!m_option) {
+        throw std::invalid_argument("Option cannot be null.");
+    }
+}
+
+Price AmericanApproximationModel::calculatePrice() const {
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_cache, spec, americanTag(m_settings),
+                  cache::Quantity::Price,
+                  [&] { return americanPrice(spec, m_settings); });
+}
+AmericanEstimate AmericanApproximationModel::calculateEstimate() const {
+    return americanEstimate(m_option->getSpec(), m_settings);
+}
+Valuation AmericanApproximationModel::calculateValuation() const {
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_cache, spec, americanTag(m_settings),
+                  cache::Quantity::Valuation,
+                  [&] { return americanValuation(spec, m_settings); });
+}
+
+FiniteDifferenceModel::FiniteDifferenceModel(
+    const std::shared_ptr<options::Option> &option,
+    const FiniteDifferenceSettings &settings)
+    : m_option(option), m_settings(settings) {
+    if (!m_option) {
+        throw std::invalid_argument("Option cannot be null.");
+    }
+}
+
+Price FiniteDifferenceModel::calculatePrice() const {
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_payoff ? nullptr : m_cache, spec,
+                  finiteDifferenceTag(m_settings), cache::Quantity::Price,
+                  [&] {
+                      return finiteDifferencePrice(spec, m_settings,
+                                                   m_payoff);
+                  });
+}
+Valuation FiniteDifferenceModel::calculateValuation() const {
+    options::ContractSpec spec = m_option->getSpec();
+    return cached(m_payoff ? nullptr : m_cache, spec,
+                  finiteDifferenceTag(m_settings),
+                  cache::Quantity::Valuation, [&] {
+                      return finiteDifferenceValuation(spec, m_settings,
+                                                       m_payoff);
+                  });
+}
+FiniteDifferenceGrid FiniteDifferenceModel::calculateGrid() const {
+    return finiteDifferenceGrid(m_option->getSpec(), m_settings, m_payoff);
 }
 } // namespace model
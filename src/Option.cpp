@@ -35,6 +35,27 @@ Option::Option(Price spotPrice, Price strikePrice, Rate interestRate,
     }
     m_maturity = months / 12.0;
 }
+Option::Option(Price spotPrice, Price strikePrice, Rate interestRate,
+               double maturity, Rate volatility, OptionType type,
+               ExerciseStyle style, Rate yield)
+    : m_spotPrice(spotPrice), m_strikePrice(strikePrice),
+      m_interestRate(interestRate), m_maturity(maturity),
+      m_volatility(volatility), m_yield(yield), m_type(type), m_style(style) {
+    if (spotPrice <= 0.0 || strikePrice <= 0.0 || volatility <= 0.0 ||
+        maturity <= 0.0) {
+        throw std::invalid_argument(
+            "Spot price, strike price, maturity and volatility must be "
+            "positive values.");
+    }
+}
+Option::Option(const ContractSpec &spec)
+    : Option(spec.spotPrice, spec.strikePrice, spec.interestRate,
+             spec.maturity, spec.volatility, spec.type, spec.style,
+             spec.yield) {}
+ContractSpec Option::getSpec() const {
+    return {m_spotPrice,  m_strikePrice, m_interestRate, m_maturity,
+            m_volatility, m_yield,       m_type,         m_style};
+}
 Price Option::getSpotPrice() const { return m_spotPrice; }
 Price Option::getStrikePrice() const { return m_strikePrice; }
 Rate Option::getInterestRate() const { return m_interestRate; }
@@ -0,0 +1,38 @@
+#include <options-pricing-engine/Payoff.hpp>
+
+namespace options {
+namespace {
+void checkStrike(Price strike) {
+    if (!(strike > 0.0)) {
+        throw std::invalid_argument("Strike price must be positive.");
+    }
+}
+} // namespace
+
+Payoff makeVanillaPayoff(OptionType type, Price strike) {
+    checkStrike(strike);
+    return dispatch(type, [&](auto type) -> Payoff {
+        return VanillaPayoff<type()>{strike};
+    });
+}
+
+Payoff makeDigitalPayoff(OptionType type, Price strike, Price cash) {
+    checkStrike(strike);
+    if (!(cash > 0.0)) {
+        throw std::invalid_argument("Digital cash amount must be positive.");
+    }
+    return dispatch(type, [&](auto type) -> Payoff {
+        return DigitalPayoff<type()>{strike, cash};
+    });
+}
+
+Payoff makePowerPayoff(OptionType type, Price strike, double exponent) {
+    checkStrike(strike);
+    if (!(exponent > 0.0)) {
+        throw std::invalid_argument("Power exponent must be positive.");
+    }
+    return dispatch(type, [&](auto type) -> Payoff {
+        return PowerPayoff<type()>{strike, exponent};
+    });
+}
+} // namespace options
@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <limits>
+#include <options-pricing-engine/Portfolio.hpp>
+#include <options-pricing-engine/Random.hpp>
+#include <options-pricing-engine/ThreadPool.hpp>
+#include <stdexcept>
+
+namespace portfolio {
+namespace {
+// Rough single core costs measured with options_pricing_bench. Only their
+// ratios matter to the schedule.
+constexpr double closedFormNanoseconds = 60.0;
+constexpr double latticeNodeNanoseconds = 1.0;
+constexpr double americanNodeNanoseconds = 2.0;
+constexpr double pathNanoseconds = 15.0;
+// One path over one exercise date of an American Monte Carlo pricing.
+constexpr double exerciseStepNanoseconds = 45.0;
+// Both American approximations, before any lattice fallback.
+constexpr double approximationNanoseconds = 7000.0;
+// One grid node over one time step; American solves iterate about three
+// times per step.
+constexpr double gridNodeNanoseconds = 8.0;
+constexpr double gridIterations = 3.0;
+
+using Clock = std::chrono::steady_clock;
+
+struct Task {
+    PricingModel model;
+    // Range of the model's position list.
+    std::size_t begin;
+    std::size_t end;
+    double cost;
+};
+
+std::size_t index(PricingModel model) {
+    return static_cast<std::size_t>(model);
+}
+
+} // namespace
+
+const char *toString(PricingModel model) {
+    switch (model) {
+    case PricingModel::BlackScholes:
+        return "blackscholes";
+    case PricingModel::Binomial:
+        return "binomial";
+    case PricingModel::MonteCarlo:
+        return "montecarlo";
+    case PricingModel::American:
+        return "american";
+    case PricingModel::FiniteDifference:
+        return "pde";
+    default:
+        return "unknown";
+    }
+}
+
+int resolution(const Position &position, const PortfolioSettings &settings) {
+    if (position.resolution > 0) {
+        return position.resolution;
+    }
+    return position.model == PricingModel::Binomial ? settings.binomialSteps
+                                                    : settings.monteCarloPaths;
+}
+
+model::AmericanSettings americanSettings(const Position &position,
+                                         const PortfolioSettings &settings) {
+    model::AmericanSettings american = settings.american;
+    if (position.resolution > 0) {
+        american.fallbackSteps = position.resolution;
+    }
+    return american;
+}
+
+model::FiniteDifferenceSettings
+finiteDifferenceSettings(const Position &position,
+                         const PortfolioSettings &settings) {
+    model::FiniteDifferenceSettings finiteDifference =
+        settings.finiteDifference;
+    if (position.resolution > 0) {
+        finiteDifference.timeSteps = position.resolution;
+    }
+    return finiteDifference;
+}
+
+model::MonteCarloSettings monteCarloSettings(const Position &position,
+                                             const PortfolioSettings &settings,
+                                             std::uint64_t seed) {
+    model::MonteCarloSettings monteCarlo;
+    monteCarlo.paths = resolution(position, settings);
+    monteCarlo.seed = seed;
+    monteCarlo.threads = 1;
+    if (position.option.getStyle() == options::ExerciseStyle::European) {
+        monteCarlo.varianceReduction = settings.varianceReduction;
+    }
+    return monteCarlo;
+}
+
+Price pricePosition(const Position &position,
+                    const options::ContractSpec &spec,
+                    const PortfolioSettings &settings, std::uint64_t seed) {
+    switch (position.model) {
+    case PricingModel::BlackScholes:
+        return model::blackScholesPrice(spec);
+    case PricingModel::Binomial: {
+        thread_local model::LatticeWorkspace workspace;
+        return model::binomialPrice(spec, resolution(position, settings),
+                                    workspace);
+    }
+    case PricingModel::MonteCarlo:
+        return model::monteCarloEstimate(
+                   spec, monteCarloSettings(position, settings, seed))
+            .price;
+    case PricingModel::American:
+        return model::americanPrice(spec,
+                                    americanSettings(position, settings));
+    case PricingModel::FiniteDifference:
+        return model::finiteDifferencePrice(
+            spec, finiteDifferenceSettings(position, settings));
+    default:
+        throw std::invalid_argument("Unknown pricing model.");
+    }
+}
+
+double estimateCost(const Position &position,
+                    const PortfolioSettings &settings) {
+    switch (position.model) {
+    case PricingModel::BlackScholes:
+        return closedFormNanoseconds;
+    case PricingModel::Binomial: {
+        double steps = resolution(position, settings);
+        double nodes = 0.5 * steps * (steps + 1.0);
+        return nodes * (position.option.getStyle() ==
+                                options::ExerciseStyle::American
+                            ? americanNodeNanoseconds
+                            : latticeNodeNanoseconds);
+    }
+    case PricingModel::MonteCarlo:
+        if (position.option.getStyle() == options::ExerciseStyle::American) {
+            return resolution(position, settings) *
+                   model::MonteCarloSettings{}.exerciseDates *
+                   exerciseStepNanoseconds;
+        }
+        return resolution(position, settings) * pathNanoseconds;
+    case PricingModel::American: {
+        // Whether a contract falls back is only known once it is priced, so
+        // the lattice is budgeted for every American one that may. BBSR
+        // rolls back trees of n and n / 2 steps.
+        double steps = americanSettings(position, settings).fallbackSteps;
+        if (steps == 0.0 ||
+            position.option.getStyle() != options::ExerciseStyle::American) {
+            return approximationNanoseconds;
+        }
+        return approximationNanoseconds +
+               1.25 * 0.5 * steps * (steps + 1.0) * americanNodeNanoseconds;
+    }
+    case PricingModel::FiniteDifference: {
+        model::FiniteDifferenceSettings grid =
+            finiteDifferenceSettings(position, settings);
+        double nodes = static_cast<double>(grid.spotNodes) * grid.timeSteps;
+        return nodes * gridNodeNanoseconds *
+               (position.option.getStyle() == options::ExerciseStyle::American
+                    ? gridIterations
+                    : 1.0);
+    }
+    default:
+        return closedFormNanoseconds;
+    }
+}
+
+PortfolioReport pricePortfolio(const std::vector<Position> &positions,
+                               const PortfolioSettings &settings) {
+    if (settings.binomialSteps <= 0 || settings.monteCarloPaths <= 0) {
+        throw std::invalid_argument(
+            "Steps and paths must be positive integers.");
+    }
+    const std::uint64_t seed =
+        settings.seed == 0 ? rng::randomSeed() : settings.seed;
+    PortfolioReport report;
+    report.prices.assign(positions.size(),
+                         std::numeric_limits<Price>::quiet_NaN());
+    report.errors.resize(positions.size());
+
+    // Group each model's positions, in book order, into tasks that reach the
+    // grain, then run the most expensive tasks first.
+    std::array<std::vector<std::size_t>, pricingModelCount> members;
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        members[index(positions[i].model)].push_back(i);
+    }
+    std::vector<Task> tasks;
+    for (std::size_t m = 0; m < pricingModelCount; ++m) {
+        report.models[m].positions = members[m].size();
+        Task task{static_cast<PricingModel>(m), 0, 0, 0.0};
+        for (std::size_t i = 0; i < members[m].size(); ++i) {
+            task.cost += estimateCost(positions[members[m][i]], settings);
+            task.end = i + 1;
+            if (task.cost >= settings.grainNanoseconds ||
+                task.end == members[m].size()) {
+                tasks.push_back(task);
+                task.begin = task.end;
+                task.cost = 0.0;
+            }
+        }
+    }
+    std::stable_sort(
+        tasks.begin(), tasks.end(),
+        [](const Task &a, const Task &b) { return a.cost > b.cost; });
+
+    parallel::ThreadPool &pool = parallel::ThreadPool::shared();
+    report.threads = pool.getWorkers() + 1;
+    if (settings.threads > 0) {
+        report.threads = std::min(report.threads, settings.threads);
+    }
+    std::array<std::atomic<std::uint64_t>, pricingModelCount> busy{};
+    std::array<std::atomic<std::size_t>, pricingModelCount> counts{};
+    auto start = Clock::now();
+    pool.parallelFor(
+        tasks.size(),
+        [&](std::size_t t) {
+            const Task &task = tasks[t];
+            const std::vector<std::size_t> &rows = members[index(task.model)];
+            auto taskStart = Clock::now();
+            for (std::size_t i = task.begin; i < task.end; ++i) {
+                std::size_t row = rows[i];
+                try {
+                    const Position &position = positions[row];
+                    options::ContractSpec spec = position.option.getSpec();
+                    if (settings.surface) {
+                        spec = settings.surface->apply(spec);
+                    }
+                    report.prices[row] =
+                        pricePosition(position, spec, settings, seed);
+                } catch (const std::exception &e) {
+                    report.errors[row] = e.what();
+                }
+            }
+            busy[index(task.model)] += static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - taskStart)
+                    .count());
+            ++counts[index(task.model)];
+        },
+        settings.threads);
+    report.wallSeconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+
+    double available = report.wallSeconds * report.threads;
+    for (std::size_t m = 0; m < pricingModelCount; ++m) {
+        ModelUtilization &model = report.models[m];
+        model.tasks = counts[m];
+        model.busySeconds = busy[m] * 1e-9;
+        model.utilization =
+            available > 0.0 ? model.busySeconds / available : 0.0;
+    }
+    return report;
+}
+} // namespace portfolio
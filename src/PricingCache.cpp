@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <options-pricing-engine/PricingCache.hpp>
+#include <stdexcept>
+
+namespace cache {
+namespace {
+// Shards of a cache whose capacity allows; smaller caches get one shard
+// per entry.
+constexpr std::size_t maxShards = 16;
+
+std::int64_t quantize(double value, double step) {
+    if (step > 0.0) {
+        return std::llround(value / step);
+    }
+    std::int64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// SplitMix64 finaliser.
+std::uint64_t mix(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+} // namespace
+
+std::size_t PricingCache::KeyHash::operator()(const Key &key) const {
+    std::uint64_t hash = mix(key.seed);
+    for (std::int64_t input : key.inputs) {
+        hash = mix(hash ^ static_cast<std::uint64_t>(input));
+    }
+    for (std::uint64_t parameter : key.parameters) {
+        hash = mix(hash ^ parameter);
+    }
+    std::uint64_t tags = static_cast<std::uint32_t>(key.resolution);
+    tags = tags << 8 | static_cast<std::uint8_t>(key.model);
+    tags = tags << 8 | static_cast<std::uint8_t>(key.quantity);
+    tags = tags << 8 | key.variant;
+    tags = tags << 4 | static_cast<std::uint8_t>(key.type);
+    tags = tags << 4 | static_cast<std::uint8_t>(key.style);
+    return mix(hash ^ tags);
+}
+
+PricingCache::PricingCache(const CacheSettings &settings)
+    : m_settings(settings), m_shards(std::min(maxShards, settings.capacity)) {
+    if (settings.capacity == 0) {
+        throw std::invalid_argument("Cache capacity must be positive.");
+    }
+    const Quantization &steps = settings.quantization;
+    if (steps.price < 0.0 || steps.rate < 0.0 || steps.maturity < 0.0) {
+        throw std::invalid_argument(
+            "Quantization steps cannot be negative.");
+    }
+    // The first capacity % shards shards take one entry more, so the shares
+    // add up to the capacity.
+    std::size_t share = settings.capacity / m_shards.size();
+    std::size_t remainder = settings.capacity % m_shards.size();
+    for (std::size_t i = 0; i < m_shards.size(); ++i) {
+        m_shards[i].capacity = share + (i < remainder ? 1 : 0);
+    }
+}
+
+Key PricingCache::makeKey(const options::ContractSpec &spec, ModelKind model,
+                          Quantity quantity, int resolution,
+                          std::uint64_t seed, std::uint8_t variant,
+                          const Parameters &parameters) const {
+    const Quantization &steps = m_settings.quantization;
+    Key key;
+    key.inputs = {quantize(spec.spotPrice, steps.price),
+                  quantize(spec.strikePrice, steps.price),
+                  quantize(spec.interestRate, steps.rate),
+                  quantize(spec.maturity, steps.maturity),
+                  quantize(spec.volatility, steps.rate),
+                  quantize(spec.yield, steps.rate)};
+    key.parameters = parameters;
+    key.seed = seed;
+    key.resolution = resolution;
+    key.model = model;
+    key.quantity = quantity;
+    key.variant = variant;
+    key.type = spec.type;
+    key.style = spec.style;
+    return key;
+}
+
+PricingCache::Shard &PricingCache::shard(const Key &key) {
+    // The low bits pick the bucket inside the shard, so the shard is taken
+    // from the high ones.
+    return m_shards[(KeyHash{}(key) >> 48) % m_shards.size()];
+}
+
+std::optional<model::Valuation> PricingCache::find(const Key &key) {
+    Shard &s = shard(key);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto found = s.index.find(key);
+    if (found == s.index.end()) {
+        ++s.misses;
+        return std::nullopt;
+    }
+    ++s.hits;
+    s.entries.splice(s.entries.begin(), s.entries, found->second);
+    return found->second->second;
+}
+
+void PricingCache::insert(const Key &key, const model::Valuation &value) {
+    Shard &s = shard(key);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto found = s.index.find(key);
+    if (found != s.index.end()) {
+        found->second->second = value;
+        s.entries.splice(s.entries.begin(), s.entries, found->second);
+        return;
+    }
+    s.entries.emplace_front(key, value);
+    s.index.emplace(key, s.entries.begin());
+    if (s.entries.size() > s.capacity) {
+        s.index.erase(s.entries.back().first);
+        s.entries.pop_back();
+        ++s.evictions;
+    }
+}
+
+CacheStats PricingCache::getStats() const {
+    CacheStats stats;
+    for (const Shard &s : m_shards) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        stats.hits += s.hits;
+        stats.misses += s.misses;
+        stats.evictions += s.evictions;
+        stats.size += s.entries.size();
+    }
+    return stats;
+}
+
+void PricingCache::clear() {
+    for (Shard &s : m_shards) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.entries.clear();
+        s.index.clear();
+        s.hits = s.misses = s.evictions = 0;
+    }
+}
+} // namespace cache
@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <options-pricing-engine/PricingGraph.hpp>
+#include <options-pricing-engine/Random.hpp>
+#include <options-pricing-engine/ThreadPool.hpp>
+#include <stdexcept>
+#include <utility>
+
+namespace graph {
+namespace {
+// Contracts per task, so a tick touching a handful of contracts stays on
+// the calling thread.
+constexpr std::size_t repriceChunk = 64;
+} // namespace
+
+PricingGraph::PricingGraph(std::uint64_t seed)
+    : m_seed(seed == 0 ? rng::randomSeed() : seed) {}
+
+NodeId PricingGraph::addNode(NodeKind kind) {
+    m_nodes.push_back({kind, 0.0, nullptr, {}});
+    return m_nodes.size() - 1;
+}
+
+PricingGraph::Node &PricingGraph::node(NodeId id, NodeKind kind) {
+    if (id >= m_nodes.size() || m_nodes[id].kind != kind) {
+        throw std::invalid_argument(
+            "Node does not exist or is of another kind.");
+    }
+    return m_nodes[id];
+}
+
+NodeId PricingGraph::addSpot(Price spot) {
+    NodeId id = addNode(NodeKind::Spot);
+    setSpot(id, spot);
+    return id;
+}
+
+NodeId PricingGraph::addRate(Rate rate) {
+    NodeId id = addNode(NodeKind::Rate);
+    setRate(id, rate);
+    return id;
+}
+
+NodeId PricingGraph::addVolatility(Rate volatility) {
+    NodeId id = addNode(NodeKind::Volatility);
+    setVolatility(id, volatility);
+    return id;
+}
+
+NodeId PricingGraph::addSurface(
+    std::shared_ptr<const surface::VolatilitySurface> surface) {
+    NodeId id = addNode(NodeKind::Volatility);
+    setSurface(id, std::move(surface));
+    return id;
+}
+
+void PricingGraph::setSpot(NodeId id, Price spot) {
+    if (!(spot > 0.0)) {
+        throw std::invalid_argument("Spot price must be positive.");
+    }
+    Node &spotNode = node(id, NodeKind::Spot);
+    spotNode.value = spot;
+    mark(spotNode, PriceDirty);
+}
+
+void PricingGraph::setRate(NodeId id, Rate rate) {
+    if (!std::isfinite(rate)) {
+        throw std::invalid_argument("Interest rate must be finite.");
+    }
+    Node &rateNode = node(id, NodeKind::Rate);
+    rateNode.value = rate;
+    mark(rateNode, PriceDirty | TermsDirty);
+}
+
+void PricingGraph::setVolatility(NodeId id, Rate volatility) {
+    if (!(volatility > 0.0)) {
+        throw std::invalid_argument("Volatility must be positive.");
+    }
+    Node &volatilityNode = node(id, NodeKind::Volatility);
+    volatilityNode.value = volatility;
+    volatilityNode.surface.reset();
+    mark(volatilityNode, PriceDirty | TermsDirty);
+}
+
+void PricingGraph::setSurface(
+    NodeId id, std::shared_ptr<const surface::VolatilitySurface> surface) {
+    if (!surface) {
+        throw std::invalid_argument("Volatility surface cannot be null.");
+    }
+    Node &volatilityNode = node(id, NodeKind::Volatility);
+    volatilityNode.surface = std::move(surface);
+    mark(volatilityNode, PriceDirty | TermsDirty);
+}
+
+ContractId PricingGraph::addContract(const options::ContractSpec &spec,
+                                     NodeId spot, NodeId rate,
+                                     NodeId volatility,
+                                     portfolio::PricingModel model,
+                                     int resolution) {
+    if (!(spec.strikePrice > 0.0) || !(spec.maturity > 0.0)) {
+        throw std::invalid_argument(
+            "Strike price and maturity must be positive values.");
+    }
+    if (resolution < 0) {
+        throw std::invalid_argument(
+            "Steps and paths must be positive integers.");
+    }
+    if (model == portfolio::PricingModel::BlackScholes &&
+        spec.style == options::ExerciseStyle::American) {
+        throw std::invalid_argument("Option exercise style must be European");
+    }
+    node(spot, NodeKind::Spot);
+    node(rate, NodeKind::Rate);
+    node(volatility, NodeKind::Volatility);
+    if (resolution == 0 && model != portfolio::PricingModel::BlackScholes) {
+        portfolio::PortfolioSettings defaults;
+        switch (model) {
+        case portfolio::PricingModel::Binomial:
+            resolution = defaults.binomialSteps;
+            break;
+        case portfolio::PricingModel::American:
+            resolution = defaults.american.fallbackSteps;
+            break;
+        case portfolio::PricingModel::FiniteDifference:
+            resolution = defaults.finiteDifference.timeSteps;
+            break;
+        default:
+            resolution = defaults.monteCarloPaths;
+        }
+    }
+    ContractId id = m_contracts.size();
+    m_contracts.push_back({spec, spot, rate, volatility, model, resolution,
+                           {}, {}, {},
+                           std::numeric_limits<Price>::quiet_NaN(),
+                           PriceDirty | TermsDirty});
+    m_nodes[spot].subscribers.push_back(id);
+    m_nodes[rate].subscribers.push_back(id);
+    m_nodes[volatility].subscribers.push_back(id);
+    m_pending.push_back(id);
+    return id;
+}
+
+void PricingGraph::mark(const Node &node, std::uint8_t dirty) {
+    for (ContractId id : node.subscribers) {
+        Contract &contract = m_contracts[id];
+        if (!(contract.dirty & PriceDirty)) {
+            m_pending.push_back(id);
+        }
+        contract.dirty |= dirty;
+    }
+}
+
+void PricingGraph::reprice(Contract &contract) const {
+    options::ContractSpec &spec = contract.spec;
+    if (contract.dirty & TermsDirty) {
+        const Node &volatility = m_nodes[contract.volatility];
+        spec.interestRate = m_nodes[contract.rate].value;
+        spec.volatility =
+            volatility.surface
+                ? volatility.surface->volatility(spec.maturity,
+                                                 spec.strikePrice)
+                : volatility.value;
+        if (contract.model == portfolio::PricingModel::BlackScholes) {
+            contract.terms = model::blackScholesTerms(spec);
+        } else if (contract.model == portfolio::PricingModel::Binomial) {
+            contract.lattice =
+                model::binomialLattice(spec, contract.resolution);
+        } else if (contract.model ==
+                   portfolio::PricingModel::FiniteDifference) {
+            // Solved below at the current spot.
+            contract.grid = {};
+        }
+    }
+    spec.spotPrice = m_nodes[contract.spot].value;
+    switch (contract.model) {
+    case portfolio::PricingModel::BlackScholes:
+        contract.price = model::blackScholesPrice(spec, contract.terms);
+        break;
+    case portfolio::PricingModel::Binomial: {
+        thread_local model::LatticeWorkspace workspace;
+        contract.price =
+            model::binomialPrice(spec, contract.lattice, workspace);
+        break;
+    }
+    case portfolio::PricingModel::MonteCarlo: {
+        model::MonteCarloSettings settings;
+        settings.paths = contract.resolution;
+        settings.seed = m_seed;
+        settings.threads = 1;
+        contract.price = model::monteCarloEstimate(spec, settings).price;
+        break;
+    }
+    case portfolio::PricingModel::American: {
+        model::AmericanSettings settings;
+        settings.fallbackSteps = contract.resolution;
+        contract.price = model::americanPrice(spec, settings);
+        break;
+    }
+    case portfolio::PricingModel::FiniteDifference: {
+        if (!contract.grid.contains(spec.spotPrice)) {
+            model::FiniteDifferenceSettings settings;
+            settings.timeSteps = contract.resolution;
+            contract.grid = model::finiteDifferenceGrid(spec, settings);
+        }
+        contract.price = contract.grid.valuationAt(spec.spotPrice).price;
+        break;
+    }
+    default:
+        throw std::invalid_argument("Unknown pricing model.");
+    }
+}
+
+UpdateStats PricingGraph::update() {
+    UpdateStats stats;
+    stats.repriced = m_pending.size();
+    for (ContractId id : m_pending) {
+        if (m_contracts[id].dirty & TermsDirty) {
+            ++stats.rebuilt;
+        }
+    }
+    std::size_t chunks = (m_pending.size() + repriceChunk - 1) / repriceChunk;
+    parallel::ThreadPool::shared().parallelFor(chunks, [&](std::size_t c) {
+        std::size_t begin = c * repriceChunk;
+        std::size_t end = std::min(begin + repriceChunk, m_pending.size());
+        for (std::size_t i = begin; i < end; ++i) {
+            Contract &contract = m_contracts[m_pending[i]];
+            try {
+                reprice(contract);
+                contract.dirty = 0;
+            } catch (const std::exception &) {
+                // The terms may be half built, so the next change of any
+                // input rebuilds them.
+                contract.price = std::numeric_limits<Price>::quiet_NaN();
+                contract.dirty = TermsDirty;
+            }
+        }
+    });
+    m_pending.clear();
+    return stats;
+}
+
+Price PricingGraph::getPrice(ContractId contract) const {
+    if (contract >= m_contracts.size()) {
+        throw std::invalid_argument("Contract does not exist.");
+    }
+    return m_contracts[contract].price;
+}
+} // namespace graph
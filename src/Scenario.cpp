@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <options-pricing-engine/Batch.hpp>
+#include <options-pricing-engine/Model.hpp>
+#include <options-pricing-engine/Random.hpp>
+#include <options-pricing-engine/Scenario.hpp>
+#include <options-pricing-engine/ThreadPool.hpp>
+#include <stdexcept>
+
+namespace scenario {
+namespace {
+using portfolio::PricingModel;
+
+// Closed form positions per batch kernel call; with a 21 by 11 by 5 grid
+// this is about 18000 rows, which stays in cache.
+constexpr std::size_t closedFormChunk = 16;
+constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+void checkGrid(const ShockGrid &grid) {
+    if (grid.spot.empty() || grid.volatility.empty() || grid.rate.empty()) {
+        throw std::invalid_argument("Every shock axis needs a point.");
+    }
+    for (double shock : grid.spot) {
+        if (!(shock > -1.0)) {
+            throw std::invalid_argument("Spot shocks must be above -1.");
+        }
+    }
+}
+
+// Binomial prices of the spec at every spot shock from one rollback. A
+// vanilla price is homogeneous of degree one in the spot and strike, on the
+// tree as in the model, so the price at S (1 + s) is (1 + s) times the price
+// at S of the strike K / (1 + s), and the spot shocks become a strike chain
+// on the tree of the unshocked spot.
+void latticePrices(const options::ContractSpec &spec,
+                   const std::vector<double> &spotShocks, int steps,
+                   Price *prices) {
+    thread_local std::vector<Price> strikes;
+    strikes.resize(spotShocks.size());
+    for (std::size_t s = 0; s < spotShocks.size(); ++s) {
+        strikes[s] = spec.strikePrice / (1.0 + spotShocks[s]);
+    }
+    batch::priceBinomialChain(spec, strikes.data(), strikes.size(), steps,
+                              prices);
+    for (std::size_t s = 0; s < spotShocks.size(); ++s) {
+        prices[s] *= 1.0 + spotShocks[s];
+    }
+}
+
+// The spec shocked at one volatility and rate point; its spot is set per
+// spot shock.
+options::ContractSpec shocked(options::ContractSpec spec, double volatility,
+                              double rate) {
+    spec.volatility += volatility;
+    spec.interestRate += rate;
+    return spec;
+}
+} // namespace
+
+std::vector<double> ShockGrid::range(double lo, double hi, std::size_t count) {
+    if (count == 0) {
+        return {};
+    }
+    if (count == 1) {
+        return {lo};
+    }
+    std::vector<double> shocks(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        shocks[i] = lo + (hi - lo) * i / (count - 1);
+    }
+    return shocks;
+}
+
+std::vector<double> PnLCube::aggregate() const {
+    const std::size_t points = spots * volatilities * rates;
+    std::vector<double> total(points, 0.0);
+    for (std::size_t p = 0; p < positions; ++p) {
+        if (std::isnan(basePrices[p])) {
+            continue;
+        }
+        const double *cells = values.data() + p * points;
+        for (std::size_t i = 0; i < points; ++i) {
+            total[i] += cells[i];
+        }
+    }
+    return total;
+}
+
+PnLCube revalue(const std::vector<portfolio::Position> &positions,
+                const ShockGrid &grid,
+                const portfolio::PortfolioSettings &settings) {
+    checkGrid(grid);
+    if (settings.binomialSteps <= 0 || settings.monteCarloPaths <= 0) {
+        throw std::invalid_argument(
+            "Steps and paths must be positive integers.");
+    }
+    const std::uint64_t seed =
+        settings.seed == 0 ? rng::randomSeed() : settings.seed;
+    const std::size_t nSpot = grid.spot.size();
+    const std::size_t nVolatility = grid.volatility.size();
+    const std::size_t nRate = grid.rate.size();
+    const std::size_t points = grid.size();
+    // Volatility and rate pairs, each sharing one set of spot independent
+    // terms across the spot shocks.
+    const std::size_t pairs = nVolatility * nRate;
+
+    PnLCube cube;
+    cube.positions = positions.size();
+    cube.spots = nSpot;
+    cube.volatilities = nVolatility;
+    cube.rates = nRate;
+    cube.basePrices.assign(positions.size(), nan);
+    cube.values.assign(positions.size() * points, nan);
+
+    std::vector<options::ContractSpec> specs(positions.size());
+    std::vector<std::size_t> closedForm, lattice, pointwise;
+    for (std::size_t p = 0; p < positions.size(); ++p) {
+        try {
+            specs[p] = positions[p].option.getSpec();
+            if (settings.surface) {
+                specs[p] = settings.surface->apply(specs[p]);
+            }
+        } catch (const std::exception &) {
+            continue;
+        }
+        switch (positions[p].model) {
+        case PricingModel::BlackScholes:
+            if (specs[p].style == options::ExerciseStyle::European) {
+                closedForm.push_back(p);
+            }
+            break;
+        case PricingModel::Binomial:
+        case PricingModel::FiniteDifference:
+            lattice.push_back(p);
+            break;
+        case PricingModel::MonteCarlo:
+        case PricingModel::American:
+            pointwise.push_back(p);
+            break;
+        }
+    }
+    parallel::ThreadPool &pool = parallel::ThreadPool::shared();
+
+    // Closed form: one batch row for the base and one per grid point, in
+    // cube order, so results scatter back with a single subtraction.
+    std::size_t chunks =
+        (closedForm.size() + closedFormChunk - 1) / closedFormChunk;
+    pool.parallelFor(
+        chunks,
+        [&](std::size_t c) {
+            thread_local batch::OptionBook book;
+            thread_local std::vector<Price> prices;
+            std::size_t begin = c * closedFormChunk;
+            std::size_t end =
+                std::min(begin + closedFormChunk, closedForm.size());
+            book.clear();
+            for (std::size_t i = begin; i < end; ++i) {
+                const options::ContractSpec &spec = specs[closedForm[i]];
+                book.add(spec.spotPrice, spec.strikePrice, spec.interestRate,
+                         spec.maturity, spec.volatility, spec.type,
+                         spec.style, spec.yield);
+                for (double rate : grid.rate) {
+                    for (double volatility : grid.volatility) {
+                        // Rows with no valid volatility are priced at the
+                        // base one and masked below.
+                        Rate shockedVolatility = spec.volatility + volatility;
+                        if (!(shockedVolatility > 0.0)) {
+                            shockedVolatility = spec.volatility;
+                        }
+                        for (double spot : grid.spot) {
+                            book.add(spec.spotPrice * (1.0 + spot),
+                                     spec.strikePrice,
+                                     spec.interestRate + rate, spec.maturity,
+                                     shockedVolatility, spec.type, spec.style,
+                                     spec.yield);
+                        }
+                    }
+                }
+            }
+            prices.resize(book.size());
+            batch::priceBlackScholes(book.view(), prices.data());
+            const Price *row = prices.data();
+            for (std::size_t i = begin; i < end; ++i) {
+                std::size_t p = closedForm[i];
+                Price base = *row++;
+                cube.basePrices[p] = base;
+                double *cells = cube.values.data() + p * points;
+                for (std::size_t j = 0; j < points; ++j) {
+                    double volatility =
+                        grid.volatility[j / nSpot % nVolatility];
+                    cells[j] = specs[p].volatility + volatility > 0.0
+                                   ? row[j] - base
+                                   : nan;
+                }
+                row += points;
+            }
+        },
+        settings.threads);
+
+    // Lattice, finite difference, Monte Carlo and American base prices,
+    // then the grid around them.
+    std::vector<std::size_t> numerical = lattice;
+    numerical.insert(numerical.end(), pointwise.begin(), pointwise.end());
+    auto price = [&](std::size_t p, const options::ContractSpec &spec) {
+        if (positions[p].model == PricingModel::Binomial) {
+            Price value;
+            latticePrices(spec, {0.0},
+                          portfolio::resolution(positions[p], settings),
+                          &value);
+            return value;
+        }
+        return portfolio::pricePosition(positions[p], spec, settings, seed);
+    };
+    pool.parallelFor(
+        numerical.size(),
+        [&](std::size_t i) {
+            std::size_t p = numerical[i];
+            try {
+                cube.basePrices[p] = price(p, specs[p]);
+            } catch (const std::exception &) {
+                cube.basePrices[p] = nan;
+            }
+        },
+        settings.threads);
+
+    // A lattice or finite difference task is one volatility and rate pair
+    // over every spot shock, a Monte Carlo or American task a single grid
+    // point. A lattice task prices every spot shock in one rollback. A
+    // finite difference task solves one grid and interpolates it at the
+    // shocked spots, solving again only for a spot beyond its edge.
+    pool.parallelFor(
+        lattice.size() * pairs + pointwise.size() * points,
+        [&](std::size_t task) {
+            bool isLattice = task < lattice.size() * pairs;
+            if (!isLattice) {
+                task -= lattice.size() * pairs;
+            }
+            std::size_t p = isLattice ? lattice[task / pairs]
+                                      : pointwise[task / points];
+            std::size_t cell = isLattice ? task % pairs * nSpot
+                                         : task % points;
+            std::size_t pair = cell / nSpot;
+            options::ContractSpec spec =
+                shocked(specs[p], grid.volatility[pair % nVolatility],
+                        grid.rate[pair / nVolatility]);
+            const Price base = cube.basePrices[p];
+            double *cells = cube.values.data() + p * points;
+            if (std::isnan(base) || !(spec.volatility > 0.0)) {
+                return;
+            }
+            try {
+                if (isLattice &&
+                    positions[p].model == PricingModel::FiniteDifference) {
+                    model::FiniteDifferenceGrid solved =
+                        model::finiteDifferenceGrid(
+                            spec, portfolio::finiteDifferenceSettings(
+                                      positions[p], settings));
+                    for (std::size_t s = 0; s < nSpot; ++s) {
+                        spec.spotPrice = specs[p].spotPrice *
+                                         (1.0 + grid.spot[s]);
+                        Price value =
+                            solved.contains(spec.spotPrice)
+                                ? solved.valuationAt(spec.spotPrice).price
+                                : price(p, spec);
+                        cells[cell + s] = value - base;
+                    }
+                } else if (isLattice) {
+                    latticePrices(
+                        spec, grid.spot,
+                        portfolio::resolution(positions[p], settings),
+                        cells + cell);
+                    for (std::size_t s = 0; s < nSpot; ++s) {
+                        cells[cell + s] -= base;
+                    }
+                } else {
+                    spec.spotPrice =
+                        specs[p].spotPrice * (1.0 + grid.spot[cell % nSpot]);
+                    cells[cell] = price(p, spec) - base;
+                }
+            } catch (const std::exception &) {
+                // The cells keep their NaN.
+            }
+        },
+        settings.threads);
+    return cube;
+}
+} // namespace scenario
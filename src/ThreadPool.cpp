@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <options-pricing-engine/ThreadPool.hpp>
+
+namespace parallel {
+namespace {
+thread_local bool insideTask = false;
+}
+
+// Each participant owns a range of indices dealt round-robin, so a body
+// ordered by decreasing cost hands every thread its share of the expensive
+// indices first. A participant takes indices from the front of its own range
+// and, once that is empty, steals the back half of the fullest other range.
+struct ThreadPool::Job {
+    struct alignas(64) Range {
+        std::mutex mutex;
+        // Indices offset + k * stride for k in [begin, end).
+        std::size_t offset{0};
+        std::size_t begin{0};
+        std::size_t end{0};
+    };
+
+    const std::function<void(std::size_t)> *body;
+    std::size_t count;
+    unsigned participants;
+    std::unique_ptr<Range[]> ranges;
+    std::atomic<unsigned> claimed{1};
+    std::atomic<std::size_t> done{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+
+    Job(const std::function<void(std::size_t)> &body, std::size_t count,
+        unsigned participants)
+        : body(&body), count(count), participants(participants),
+          ranges(new Range[participants]) {
+        for (unsigned p = 0; p < participants; ++p) {
+            ranges[p].offset = p;
+            ranges[p].end = (count - p + participants - 1) / participants;
+        }
+    }
+
+    bool pop(unsigned self, std::size_t &index) {
+        Range &range = ranges[self];
+        std::lock_guard<std::mutex> lock(range.mutex);
+        if (range.begin == range.end) {
+            return false;
+        }
+        index = range.offset + range.begin++ * participants;
+        return true;
+    }
+
+    bool steal(unsigned self) {
+        while (true) {
+            unsigned victim = self;
+            std::size_t most = 0;
+            for (unsigned p = 0; p < participants; ++p) {
+                Range &range = ranges[p];
+                std::lock_guard<std::mutex> lock(range.mutex);
+                if (p != self && range.end - range.begin > most) {
+                    most = range.end - range.begin;
+                    victim = p;
+                }
+            }
+            if (victim == self) {
+                return false;
+            }
+            std::size_t offset, begin, end;
+            {
+                Range &range = ranges[victim];
+                std::lock_guard<std::mutex> lock(range.mutex);
+                if (range.begin == range.end) {
+                    continue;
+                }
+                offset = range.offset;
+                end = range.end;
+                begin = range.begin + (range.end - range.begin) / 2;
+                range.end = begin;
+            }
+            Range &own = ranges[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.offset = offset;
+            own.begin = begin;
+            own.end = end;
+            return true;
+        }
+    }
+
+    void run(unsigned self) {
+        bool wasInside = insideTask;
+        insideTask = true;
+        std::size_t processed = 0;
+        std::size_t i;
+        while (pop(self, i) || (steal(self) && pop(self, i))) {
+            try {
+                (*body)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            ++processed;
+        }
+        insideTask = wasInside;
+        if (processed > 0 && (done += processed) == count) {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.notify_all();
+        }
+    }
+};
+
+ThreadPool::ThreadPool(unsigned workers) {
+    m_threads.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i) {
+        m_threads.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    std::uint64_t seen = 0;
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) {
+                return;
+            }
+            seen = m_generation;
+            job = m_job;
+        }
+        if (job) {
+            unsigned self = job->claimed++;
+            if (self < job->participants) {
+                job->run(self);
+            }
+        }
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count,
+                             const std::function<void(std::size_t)> &body,
+                             unsigned maxThreads) {
+    if (count == 0) {
+        return;
+    }
+    if (insideTask || maxThreads == 1 || m_threads.empty() || count == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+    std::lock_guard<std::mutex> submit(m_submitMutex);
+    unsigned helpers = static_cast<unsigned>(m_threads.size());
+    if (maxThreads > 0) {
+        helpers = std::min(helpers, maxThreads - 1);
+    }
+    helpers = static_cast<unsigned>(std::min<std::size_t>(helpers, count - 1));
+    auto job = std::make_shared<Job>(body, count, helpers + 1);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = job;
+        ++m_generation;
+    }
+    m_wake.notify_all();
+    job->run(0);
+    {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->finished.wait(lock, [&] { return job->done == count; });
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job.reset();
+    }
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+ThreadPool &ThreadPool::shared() {
+    // The calling thread also works, so one worker fewer than the hardware
+    // keeps every core busy without oversubscribing.
+    static const unsigned hardware = std::thread::hardware_concurrency();
+    static ThreadPool pool(hardware > 1 ? hardware - 1 : 1);
+    return pool;
+}
+} // namespace parallel
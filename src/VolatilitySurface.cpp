@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <options-pricing-engine/Batch.hpp>
+#include <options-pricing-engine/ThreadPool.hpp>
+#include <options-pricing-engine/VolatilitySurface.hpp>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace surface {
+namespace {
+// Quotes per batch solver call on one thread.
+constexpr std::size_t inversionChunk = 1024;
+
+void checkMarket(const Market &market) {
+    if (!(market.spot > 0.0)) {
+        throw std::invalid_argument("Spot price must be positive.");
+    }
+}
+
+void checkIncreasing(const std::vector<double> &values, const char *name) {
+    if (values.empty()) {
+        throw std::invalid_argument(std::string(name) + " cannot be empty.");
+    }
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (!(values[i] > 0.0) || (i > 0 && !(values[i] > values[i - 1]))) {
+            throw std::invalid_argument(
+                std::string(name) +
+                " must be positive and strictly increasing.");
+        }
+    }
+}
+
+double logForwardMoneyness(const Market &market, double maturity,
+                           Price strike) {
+    return std::log(strike / market.spot) -
+           (market.interestRate - market.yield) * maturity;
+}
+
+batch::OptionBookView subview(const batch::OptionBookView &book,
+                              std::size_t begin, std::size_t end) {
+    batch::OptionBookView view = book;
+    view.spot += begin;
+    view.strike += begin;
+    view.interestRate += begin;
+    view.volatility += begin;
+    view.maturity += begin;
+    view.yield += begin;
+    view.type += begin;
+    view.style += begin;
+    view.size = end - begin;
+    return view;
+}
+} // namespace
+
+double VolatilitySurface::sliceVariance(const Slice &slice,
+                                        double logMoneyness) const {
+    const Segment *begin = m_segments.data() + slice.offset;
+    const Segment *end = begin + slice.count;
+    const Segment *next = std::upper_bound(
+        begin, end, logMoneyness,
+        [](double k, const Segment &segment) { return k < segment.knot; });
+    if (next == begin) {
+        return begin->c0;
+    }
+    const Segment &segment = *(next - 1);
+    double t = logMoneyness - segment.knot;
+    return segment.c0 +
+           t * (segment.c1 + t * (segment.c2 + t * segment.c3));
+}
+
+double VolatilitySurface::totalVariance(double maturity,
+                                        double logMoneyness) const {
+    if (m_slices.empty()) {
+        throw std::runtime_error("Volatility surface has no usable quotes.");
+    }
+    std::size_t j =
+        std::upper_bound(m_maturities.begin(), m_maturities.end(), maturity) -
+        m_maturities.begin();
+    double variance;
+    if (j == 0 || j == m_slices.size()) {
+        const Slice &nearest = m_slices[j == 0 ? 0 : j - 1];
+        variance = sliceVariance(nearest, logMoneyness) * maturity /
+                   nearest.maturity;
+    } else {
+        const Slice &before = m_slices[j - 1];
+        const Slice &after = m_slices[j];
+        double weight =
+            (maturity - before.maturity) / (after.maturity - before.maturity);
+        double w0 = sliceVariance(before, logMoneyness);
+        double w1 = sliceVariance(after, logMoneyness);
+        variance = w0 + weight * (w1 - w0);
+    }
+    return std::max(variance, 0.0);
+}
+
+Rate VolatilitySurface::volatility(double maturity, Price strike) const {
+    if (!(maturity > 0.0) || !(strike > 0.0)) {
+        throw std::invalid_argument(
+            "Maturity and strike price must be positive values.");
+    }
+    double logMoneyness = logForwardMoneyness(m_market, maturity, strike);
+    return std::sqrt(totalVariance(maturity, logMoneyness) / maturity);
+}
+
+options::ContractSpec
+VolatilitySurface::apply(options::ContractSpec spec) const {
+    spec.volatility = volatility(spec.maturity, spec.strikePrice);
+    return spec;
+}
+
+SurfaceBuilder::SurfaceBuilder(const Market &market,
+                               std::vector<double> maturities,
+                               std::vector<Price> strikes)
+    : m_maturities(std::move(maturities)), m_strikes(std::move(strikes)) {
+    checkMarket(market);
+    checkIncreasing(m_maturities, "Maturities");
+    checkIncreasing(m_strikes, "Strikes");
+    std::size_t size = m_maturities.size() * m_strikes.size();
+    m_prices.assign(size, std::numeric_limits<Price>::quiet_NaN());
+    m_types.assign(size, options::OptionType::Call);
+    m_volatilities.assign(size, std::numeric_limits<Rate>::quiet_NaN());
+    m_status.assign(size, batch::VolatilityStatus::InvalidInput);
+    m_dirty.assign(size, false);
+    m_dirtyExpiries.assign(m_maturities.size(), false);
+    m_counts.assign(m_maturities.size(), 0);
+    m_surface.m_market = market;
+    m_surface.m_segments.resize(size);
+}
+
+std::size_t SurfaceBuilder::index(std::size_t expiry,
+                                  std::size_t strike) const {
+    if (expiry >= m_maturities.size() || strike >= m_strikes.size()) {
+        throw std::invalid_argument("Quote is outside the surface grid.");
+    }
+    return expiry * m_strikes.size() + strike;
+}
+
+void SurfaceBuilder::setQuote(std::size_t expiry, std::size_t strike,
+                              Price price, options::OptionType type) {
+    std::size_t i = index(expiry, strike);
+    m_prices[i] = price;
+    m_types[i] = type;
+    m_dirty[i] = true;
+    m_dirtyExpiries[expiry] = true;
+}
+
+void SurfaceBuilder::setMarket(const Market &market) {
+    checkMarket(market);
+    m_surface.m_market = market;
+    std::fill(m_dirty.begin(), m_dirty.end(), true);
+    std::fill(m_dirtyExpiries.begin(), m_dirtyExpiries.end(), true);
+}
+
+Rate SurfaceBuilder::getImpliedVolatility(std::size_t expiry,
+                                          std::size_t strike) const {
+    return m_volatilities[index(expiry, strike)];
+}
+
+batch::VolatilityStatus SurfaceBuilder::getStatus(std::size_t expiry,
+                                                  std::size_t strike) const {
+    return m_status[index(expiry, strike)];
+}
+
+std::shared_ptr<const VolatilitySurface> SurfaceBuilder::refresh() {
+    const Market &market = m_surface.m_market;
+    batch::OptionBook book;
+    std::vector<Price> prices;
+    std::vector<std::size_t> rows;
+    for (std::size_t i = 0; i < m_prices.size(); ++i) {
+        if (!m_dirty[i]) {
+            continue;
+        }
+        m_dirty[i] = false;
+        m_volatilities[i] = std::numeric_limits<Rate>::quiet_NaN();
+        m_status[i] = batch::VolatilityStatus::InvalidInput;
+        if (!(m_prices[i] > 0.0)) {
+            continue;
+        }
+        // The volatility column is not read by the solver.
+        book.add(market.spot, m_strikes[i % m_strikes.size()],
+                 market.interestRate, m_maturities[i / m_strikes.size()], 1.0,
+                 m_types[i], options::ExerciseStyle::European, market.yield);
+        prices.push_back(m_prices[i]);
+        rows.push_back(i);
+    }
+
+    std::vector<Rate> volatilities(rows.size());
+    std::vector<batch::VolatilityStatus> status(rows.size());
+    const batch::OptionBookView view = book.view();
+    std::size_t chunks = (rows.size() + inversionChunk - 1) / inversionChunk;
+    parallel::ThreadPool::shared().parallelFor(chunks, [&](std::size_t c) {
+        std::size_t begin = c * inversionChunk;
+        std::size_t end = std::min(begin + inversionChunk, rows.size());
+        batch::impliedVolatility(subview(view, begin, end),
+                                 prices.data() + begin,
+                                 volatilities.data() + begin,
+                                 status.data() + begin);
+    });
+    for (std::size_t j = 0; j < rows.size(); ++j) {
+        m_volatilities[rows[j]] = volatilities[j];
+        m_status[rows[j]] = status[j];
+    }
+    m_inverted = rows.size();
+
+    for (std::size_t e = 0; e < m_maturities.size(); ++e) {
+        if (m_dirtyExpiries[e]) {
+            fit(e);
+            m_dirtyExpiries[e] = false;
+        }
+    }
+    m_surface.m_slices.clear();
+    m_surface.m_maturities.clear();
+    for (std::size_t e = 0; e < m_maturities.size(); ++e) {
+        if (m_counts[e] > 0) {
+            m_surface.m_slices.push_back(
+                {m_maturities[e], e * m_strikes.size(), m_counts[e]});
+            m_surface.m_maturities.push_back(m_maturities[e]);
+        }
+    }
+    return std::make_shared<const VolatilitySurface>(m_surface);
+}
+
+// Natural cubic spline through the converged quotes of one expiry, with the
+// second derivatives from the tridiagonal system solved by the Thomas
+// algorithm.
+void SurfaceBuilder::fit(std::size_t expiry) {
+    const Market &market = m_surface.m_market;
+    const double T = m_maturities[expiry];
+    std::vector<double> k;
+    std::vector<double> w;
+    for (std::size_t s = 0; s < m_strikes.size(); ++s) {
+        std::size_t i = index(expiry, s);
+        if (m_status[i] == batch::VolatilityStatus::Converged) {
+            k.push_back(logForwardMoneyness(market, T, m_strikes[s]));
+            w.push_back(m_volatilities[i] * m_volatilities[i] * T);
+        }
+    }
+    const std::size_t n = k.size();
+    m_counts[expiry] = n;
+    std::vector<double> curvature(n, 0.0);
+    if (n > 2) {
+        std::vector<double> diagonal(n, 0.0);
+        std::vector<double> rhs(n, 0.0);
+        for (std::size_t i = 1; i + 1 < n; ++i) {
+            double left = k[i] - k[i - 1];
+            double right = k[i + 1] - k[i];
+            diagonal[i] = 2.0 * (left + right);
+            rhs[i] = 6.0 * ((w[i + 1] - w[i]) / right -
+                            (w[i] - w[i - 1]) / left);
+            if (i > 1) {
+                double factor = left / diagonal[i - 1];
+                diagonal[i] -= factor * left;
+                rhs[i] -= factor * rhs[i - 1];
+            }
+        }
+        for (std::size_t i = n - 1; i-- > 1;) {
+            curvature[i] =
+                (rhs[i] - (k[i + 1] - k[i]) * curvature[i + 1]) / diagonal[i];
+        }
+    }
+    VolatilitySurface::Segment *segments =
+        m_surface.m_segments.data() + expiry * m_strikes.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        VolatilitySurface::Segment &segment = segments[i];
+        segment = {k[i], w[i], 0.0, 0.0, 0.0};
+        if (i + 1 < n) {
+            double h = k[i + 1] - k[i];
+            segment.c1 = (w[i + 1] - w[i]) / h -
+                         h * (2.0 * curvature[i] + curvature[i + 1]) / 6.0;
+            segment.c2 = 0.5 * curvature[i];
+            segment.c3 = (curvature[i + 1] - curvature[i]) / (6.0 * h);
+        }
+    }
+}
+} // namespace surface
@@ -39,10 +39,7 @@ std::vector<Command> CLI::generateMenu() {
                         [this] { return isBMSet(); }});
     commands.push_back(
         {"Set Monte Carlo Model", [this] { setMonteCarloModel(); },
-         [this] {
-             return isOptionSet() && !isMCSet() &&
-                    m_option->getStyle() == options::ExerciseStyle::European;
-         }});
+         [this] { return isOptionSet(); }});
 
     commands.push_back({"Price with Monte Carlo Model",
                         [this] { priceMonteCarloModel(); },
@@ -158,21 +155,48 @@ void CLI::setMonteCarloModel() {
         std::cout << red << "No option set. Please create an option first.\n";
         return;
     }
-    if (m_option->getStyle() == options::ExerciseStyle::American) {
-        std::cout << red
-                  << "Monte Carlo Model does not support American options\n";
-        return;
-    }
-    if (isMCSet()) {
+    options::ExerciseStyle style = m_option->getStyle();
+    if (isMCSet() && style == m_MCStyle) {
         m_MC->setOption(m_option);
         std::cout << blue << "Monte Carlo Model updated successfully.\n";
         return;
     }
-    int N;
-    std::cout << blue
-              << "Enter number of iterations for the Monte Carlo Model: ";
-    std::cin >> N;
-    m_MC = std::make_shared<model::MonteCarloModel>(m_option, N);
+    int N = 0;
+    std::uint64_t seed = 0;
+    if (!isMCSet()) {
+        std::cout << blue
+                  << "Enter number of iterations for the Monte Carlo Model: ";
+        std::cin >> N;
+        std::cout << blue << "Enter random seed (0 for a random seed): ";
+        std::cin >> seed;
+    }
+    // American options take exercise dates and no variance reduction.
+    int dates = 0;
+    int mode = 0;
+    if (style == options::ExerciseStyle::American) {
+        std::cout << blue << "Enter number of exercise dates: ";
+        std::cin >> dates;
+    } else {
+        std::cout << blue
+                  << "Enter variance reduction (0 for None, 1 for Antithetic, "
+                     "2 for Control Variate, 3 for Quasi-Random): ";
+        std::cin >> mode;
+        if (mode < 0 || mode > 3) {
+            std::cout << red << "Invalid variance reduction. Try again.\n";
+            return;
+        }
+    }
+    if (!isMCSet()) {
+        m_MC = std::make_shared<model::MonteCarloModel>(
+            m_option, N, seed == 0 ? rng::randomSeed() : seed);
+    } else {
+        m_MC->setOption(m_option);
+    }
+    if (style == options::ExerciseStyle::American) {
+        m_MC->setExerciseDates(dates);
+    }
+    m_MC->setVarianceReduction(static_cast<model::VarianceReduction>(mode));
+    m_MCStyle = style;
     std::cout << blue << "Monte Carlo Model set successfully.\n";
 }
 void CLI::priceBlackScholesModel() const {
@@ -189,16 +213,17 @@ void CLI::priceBlackScholesModel() const {
                      "options.\n";
         return;
     }
-    Price price = m_BSM->calculatePrice();
-    Greek delta = m_BSM->calculateDelta(), gamma = m_BSM->calculateGamma(),
-          theta = m_BSM->calculateTheta(), vega = m_BSM->calculateVega(),
-          rho = m_BSM->calculateRho();
-    std::cout << blue << "Black-Scholes Price: " << green << price << " $\n";
-    std::cout << blue << "Option Delta: " << green << delta << "\n";
-    std::cout << blue << "Option Gamma: " << green << gamma << "\n";
-    std::cout << blue << "Option Theta: " << green << theta << "\n";
-    std::cout << blue << "Option Vega: " << green << vega << "%\n";
-    std::cout << blue << "Option Rho: " << green << rho << "%\n";
+    model::Valuation valuation = m_BSM->calculateValuation();
+    std::cout << blue << "Black-Scholes Price: " << green << valuation.price
+              << " $\n";
+    std::cout << blue << "Option Delta: " << green << valuation.delta << "\n";
+    std::cout << blue << "Option Gamma: " << green << valuation.gamma << "\n";
+    std::cout << blue << "Option Theta: " << green << valuation.theta << "\n";
+    std::cout << blue << "Option Vega: " << green << valuation.vega << "%\n";
+    std::cout << blue << "Option Rho: " << green << valuation.rho << "%\n";
+    std::cout << blue << "Option Vanna: " << green << valuation.vanna << "\n";
+    std::cout << blue << "Option Volga: " << green << valuation.volga << "\n";
+    std::cout << blue << "Option Charm: " << green << valuation.charm << "\n";
     std::cout << red << "Note: All Greeks are calculated at the current option "
               << "parameters.\n";
 }
@@ -209,34 +234,24 @@ void CLI::priceBinomialModel() const {
         std::cout << red << "Binomial Model not set. Please set it first.\n";
         return;
     }
-    Price price = m_BM->calculatePrice();
     double uptick = m_BM->getUptick(), downtick = m_BM->getDowntick(),
            probability = m_BM->getProbability();
-    int i, j;
-    std::cout << blue << "Binomial Price: " << green << price << " $\n";
     std::cout << blue << "Uptick ^: " << green << uptick << "\n";
     std::cout << blue << "Downtick v: " << green << downtick << "\n";
     std::cout << blue << "Probability p: " << green << probability << "\n";
-    std::cout << blue
-              << "To Calculate Greeks, specify indices (i, j) in the "
-                 "Binomial "
-                 "Tree. i must be less than "
-              << red << m_BM->getSteps() - 1 << blue
-              << " and j must be less than i.\nIf its not possible proceed "
-                 "with (-1,-1)\n";
-    std::cout << blue << "Enter i (step index): ";
-    std::cin >> i;
-    std::cout << blue << "Enter j (node index at step i): ";
-    std::cin >> j;
-    if (i == -1 && j == -1) {
+    if (m_BM->getSteps() < 2) {
+        std::cout << blue << "Binomial Price: " << green
+                  << m_BM->calculatePrice() << " $\n";
+        std::cout << red << "Greeks require at least two steps.\n";
         return;
     }
-    std::cout << blue << "Delta: " << green << m_BM->calculateDelta(i, j)
-              << "\n";
-    std::cout << blue << "Gamma: " << green << m_BM->calculateGamma(i, j)
-              << "\n";
-    std::cout << blue << "Theta: " << green << m_BM->calculateTheta(i, j)
-              << "\n";
+    model::Valuation valuation = m_BM->calculateValuation();
+    std::cout << blue << "Binomial Price: " << green << valuation.price
+              << " $\n";
+    std::cout << blue << "Option Delta: " << green << valuation.delta << "\n";
+    std::cout << blue << "Option Gamma: " << green << valuation.gamma << "\n";
+    std::cout << blue << "Option Theta: " << green << valuation.theta << "\n";
+    std::cout << red << "Note: Greeks are taken at the root of the tree.\n";
 }
 void CLI::priceMonteCarloModel() const {
     clearScreen();
@@ -245,24 +260,30 @@ void CLI::priceMonteCarloModel() const {
         std::cout << red << "Monte Carlo Model not set. Please set it first.\n";
         return;
     }
-    if (m_option->getStyle() == options::ExerciseStyle::American) {
-        std::cout << red
-                  << "Monte Carlo Model does not support American "
-                     "options.\n";
-        return;
-    }
-    Price price = m_MC->calculatePrice();
-    Greek delta = m_MC->calculateDelta(), gamma = m_MC->calculateGamma(),
-          theta = m_MC->calculateTheta(), vega = m_MC->calculateVega(),
-          rho = m_MC->calculateRho();
+    model::MonteCarloEstimate estimate = m_MC->calculateEstimate();
+    model::Valuation valuation = m_MC->calculateValuation();
     const int N = m_MC->getN();
     std::cout << blue << "Monte Carlo Iterations: " << green << N << "\n";
-    std::cout << blue << "Monte Carlo Price: " << green << price << " $\n";
-    std::cout << blue << "Option Delta: " << green << delta << "\n";
-    std::cout << blue << "Option Gamma: " << green << gamma << "\n";
-    std::cout << blue << "Option Theta: " << green << theta << "\n";
-    std::cout << blue << "Option Vega: " << green << vega << "%\n";
-    std::cout << blue << "Option Rho: " << green << rho << "%\n";
+    std::cout << blue << "Monte Carlo Price: " << green << estimate.price
+              << " $\n";
+    std::cout << blue << "Standard Error: " << green
+              << estimate.standardError << " $\n";
+    std::cout << blue << "95% Confidence Interval: " << green << "["
+              << estimate.lowerBound << ", " << estimate.upperBound
+              << "] $\n";
+    std::cout << blue << "Variance Reduction Factor: " << green
+              << estimate.varianceReductionFactor << "\n";
+    std::cout << blue << "Option Delta: " << green << valuation.delta << "\n";
+    // Exercise switching under the bumps leaves American gamma and theta
+    // too noisy to show.
+    if (m_option->getStyle() == options::ExerciseStyle::European) {
+        std::cout << blue << "Option Gamma: " << green << valuation.gamma
+                  << "\n";
+        std::cout << blue << "Option Theta: " << green << valuation.theta
+                  << "\n";
+    }
+    std::cout << blue << "Option Vega: " << green << valuation.vega << "%\n";
+    std::cout << blue << "Option Rho: " << green << valuation.rho << "%\n";
     std::cout << red << "Note: All Greeks are calculated at the current option "
               << "parameters.\n";
 }